@@ -0,0 +1,332 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#define BOOST_TEST_MODULE any_scope_exit
+#ifdef BOOST_TEST_DYN_LINK
+#	include <boost/test/unit_test.hpp>
+#else
+#	include <boost/test/included/unit_test.hpp>
+#endif // BOOST_TEST_DYN_LINK
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.test.hpp>
+
+/*****************************************************************************
+ * Basic operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	basic_operation_WITH_lvalue,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto func = Func{call_count};
+		auto const _ = indi::any_scope_exit{std::ref(func)};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	basic_operation_WITH_rvalue,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::any_scope_exit{Func{call_count}};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(basic_operation_WITH_function)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::any_scope_exit{indi_test::function};
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(basic_operation_WITH_lambda)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+	auto call_count_3 = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::any_scope_exit{[&call_count_1, &call_count_2, &call_count_3]
+		{
+			++call_count_1;
+			++call_count_2;
+			++call_count_3;
+		}};
+	}
+
+	BOOST_TEST(call_count_1 == 1);
+	BOOST_TEST(call_count_2 == 1);
+	BOOST_TEST(call_count_3 == 1);
+}
+
+BOOST_AUTO_TEST_CASE(basic_operation_CASE_exception)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto const _ = indi::any_scope_exit{indi_test::functor_t<int>{call_count}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+/*****************************************************************************
+ * Release operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	release_operation,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::any_scope_exit{Func{call_count}};
+
+		scope_guard.release();
+		BOOST_TEST(call_count == 0, "function called by release");
+	}
+
+	BOOST_TEST(call_count == 0, "function called despite release");
+}
+
+/*****************************************************************************
+ * When initialization of the exit function fails, the exit function
+ * argument passed to the constructor should be called (as with scope_exit).
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(exit_function_called_on_init_failure)
+{
+	// Function object whose copy constructor throws (but which can be moved
+	// without throwing, so it can be stored).
+	class functor_t
+	{
+	public:
+		explicit functor_t(int& counter) : _p_counter{&counter} {}
+		functor_t(functor_t const& other) : _p_counter{other._p_counter} { throw indi_test::exception{}; }
+		functor_t(functor_t&& other) noexcept : _p_counter{other._p_counter} {}
+
+		auto operator()() { ++(*_p_counter); }
+
+	private:
+		int* _p_counter = nullptr;
+	};
+
+	auto call_count = 0;
+	auto func = functor_t{call_count};
+
+	BOOST_CHECK_THROW(indi::any_scope_exit{func}, indi_test::exception);
+	BOOST_TEST(call_count == 1);
+}
+
+/*****************************************************************************
+ * Move tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(moving, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	auto p_scope_guard_1 = std::unique_ptr<indi::any_scope_exit<>>{new indi::any_scope_exit{Func{call_count}}};
+	auto p_scope_guard_2 = std::unique_ptr<indi::any_scope_exit<>>{new indi::any_scope_exit{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(call_count == 0, "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(call_count == 0, "function called by moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(call_count == 1);
+}
+
+// Move-assignment calls the assigned-to guard's function (as if it were
+// destroyed), and takes over the other's.
+BOOST_AUTO_TEST_CASE_TEMPLATE(move_assignment, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard_1 = indi::any_scope_exit{Func{call_count_1}};
+		auto scope_guard_2 = indi::any_scope_exit{Func{call_count_2}};
+
+		scope_guard_1 = std::move(scope_guard_2);
+		BOOST_TEST(call_count_1 == 1, "assigned-to function not called by move-assignment");
+		BOOST_TEST(call_count_2 == 0, "assigned function called by move-assignment");
+	}
+
+	BOOST_TEST(call_count_1 == 1);
+	BOOST_TEST(call_count_2 == 1);
+}
+
+BOOST_AUTO_TEST_CASE(move_assignment_CASE_released)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard_1 = indi::any_scope_exit{indi_test::functor_t<int>{call_count_1}};
+		auto scope_guard_2 = indi::any_scope_exit{indi_test::functor_t<int>{call_count_2}};
+
+		scope_guard_1.release();
+		scope_guard_2.release();
+		scope_guard_1 = std::move(scope_guard_2);
+	}
+
+	BOOST_TEST(call_count_1 == 0);
+	BOOST_TEST(call_count_2 == 0);
+}
+
+BOOST_AUTO_TEST_CASE(move_assignment_CASE_self)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::any_scope_exit{indi_test::functor_t<int>{call_count}};
+
+		auto& alias = scope_guard;
+		scope_guard = std::move(alias);
+		BOOST_TEST(call_count == 0);
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+/*****************************************************************************
+ * Containers
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(vector)
+{
+	auto call_counts = std::array<int, 100>{};
+
+	// Artificial scope
+	{
+		auto scope_guards = std::vector<indi::any_scope_exit<>>{};
+
+		// Enough to reallocate several times.
+		for (auto i = std::size_t{0}; i < call_counts.size(); ++i)
+		{
+			if (i % 2 == 0)
+				scope_guards.emplace_back(indi_test::functor_t<int>{call_counts[i]});
+			else
+				scope_guards.emplace_back(indi_test::move_only_functor_t<int>{call_counts[i]});
+		}
+
+		for (auto call_count : call_counts)
+			BOOST_TEST(call_count == 0, "function called by reallocation");
+
+		scope_guards.erase(scope_guards.begin());
+		BOOST_TEST(call_counts[0] == 1);
+		for (auto i = std::size_t{1}; i < call_counts.size(); ++i)
+			BOOST_TEST(call_counts[i] == 0, "function called by moving in erase()");
+	}
+
+	for (auto call_count : call_counts)
+		BOOST_TEST(call_count == 1);
+}
+
+/*****************************************************************************
+ * Storage
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(size)
+{
+	BOOST_TEST(sizeof(indi::any_scope_exit<>) == 4 * sizeof(void*));
+	BOOST_TEST(sizeof(indi::any_scope_exit<sizeof(void*)>) == 2 * sizeof(void*));
+}
+
+// Functions that don't fit in the storage can't be used (rather than being
+// allocated on the heap).
+BOOST_AUTO_TEST_CASE(capacity)
+{
+	struct big_functor_t
+	{
+		char data[3 * sizeof(void*) + 1];
+
+		auto operator()() const noexcept {}
+	};
+
+	struct alignas(2 * alignof(void*)) overaligned_functor_t
+	{
+		auto operator()() const noexcept {}
+	};
+
+	BOOST_TEST((not std::is_constructible_v<indi::any_scope_exit<>, big_functor_t>));
+	BOOST_TEST((std::is_constructible_v<indi::any_scope_exit<sizeof(big_functor_t)>, big_functor_t>));
+
+	BOOST_TEST((not std::is_constructible_v<indi::any_scope_exit<>, overaligned_functor_t>));
+	BOOST_TEST((std::is_constructible_v<indi::any_scope_exit<sizeof(overaligned_functor_t), alignof(overaligned_functor_t)>, overaligned_functor_t>));
+}
+
+/*****************************************************************************
+ * Special operations
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(special_operations)
+{
+	BOOST_TEST(not std::is_default_constructible_v<indi::any_scope_exit<>>);
+	BOOST_TEST(not std::is_copy_constructible_v<indi::any_scope_exit<>>);
+	BOOST_TEST(not std::is_copy_assignable_v<indi::any_scope_exit<>>);
+	BOOST_TEST(std::is_nothrow_move_constructible_v<indi::any_scope_exit<>>);
+	BOOST_TEST(std::is_nothrow_move_assignable_v<indi::any_scope_exit<>>);
+	BOOST_TEST(std::is_nothrow_destructible_v<indi::any_scope_exit<>>);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(nothrow_construction, Func, indi_test::nonthrowing_functors<int>)
+{
+	BOOST_TEST((std::is_nothrow_constructible_v<indi::any_scope_exit<>, Func>));
+}
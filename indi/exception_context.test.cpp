@@ -0,0 +1,292 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#define BOOST_TEST_MODULE exception_context
+#ifdef BOOST_TEST_DYN_LINK
+#	include <boost/test/unit_test.hpp>
+#else
+#	include <boost/test/included/unit_test.hpp>
+#endif // BOOST_TEST_DYN_LINK
+
+#include <exception>
+#include <memory>
+
+#include <ucontext.h>
+
+#define INDI_SCOPE_EXCEPTION_CONTEXTS
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.test.hpp>
+
+namespace {
+
+/*****************************************************************************
+ * Minimal ucontext-based fibers.
+ *
+ * There is only the main context and one fiber at a time. Every switch goes
+ * through `switch_to()`, which switches the exception context along with
+ * the execution context.
+ ****************************************************************************/
+
+struct context
+{
+	ucontext_t execution;
+	indi::exception_context exceptions;
+};
+
+auto main_context = context{};
+auto fiber_context = context{};
+auto p_current_context = &main_context;
+
+auto switch_to(context& to) -> void
+{
+	auto& from = *p_current_context;
+	p_current_context = &to;
+
+	indi::switch_exception_context(from.exceptions, to.exceptions);
+	swapcontext(&from.execution, &to.execution);
+}
+
+// Starts `fiber_function` on a new fiber (and switches to it).
+auto start_fiber(void (*fiber_function)()) -> void
+{
+	constexpr auto stack_size = std::size_t{256 * 1024};
+	static auto const stack = std::make_unique<char[]>(stack_size);
+
+	getcontext(&fiber_context.execution);
+	fiber_context.execution.uc_stack.ss_sp = stack.get();
+	fiber_context.execution.uc_stack.ss_size = stack_size;
+	fiber_context.execution.uc_link = nullptr;
+	makecontext(&fiber_context.execution, fiber_function, 0);
+
+	// Every fiber starts with a fresh exception context.
+	std::destroy_at(&fiber_context.exceptions);
+	std::construct_at(&fiber_context.exceptions);
+
+	switch_to(fiber_context);
+}
+
+// Switches to the other context when destroyed.
+struct switch_on_destruction
+{
+	context* p_to;
+
+	~switch_on_destruction() { switch_to(*p_to); }
+};
+
+auto fail_count = 0;
+auto success_count = 0;
+auto fiber_done = false;
+
+// The fiber functions must never return (there is no uc_link), so they
+// switch back to the main context one last time, and are never resumed.
+[[noreturn]] auto finish_fiber() -> void
+{
+	fiber_done = true;
+	switch_to(main_context);
+	std::terminate();
+}
+
+auto reset() -> void
+{
+	fail_count = 0;
+	success_count = 0;
+	fiber_done = false;
+}
+
+} // anonymous namespace
+
+/*****************************************************************************
+ * Sanity checks
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(new_context_has_no_uncaught_exceptions)
+{
+	auto const exceptions = indi::exception_context{};
+	BOOST_TEST(exceptions.uncaught_when_switched_out() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(switch_during_unwinding_counts)
+{
+	auto other = indi::exception_context{};
+
+	struct checker
+	{
+		indi::exception_context& other;
+
+		~checker()
+		{
+			BOOST_TEST(indi::_detail_X_scope::uncaught_exceptions() == 1);
+
+			indi::switch_exception_context(main_context.exceptions, other);
+			BOOST_TEST(indi::_detail_X_scope::uncaught_exceptions() == 0);
+
+			indi::switch_exception_context(other, main_context.exceptions);
+			BOOST_TEST(indi::_detail_X_scope::uncaught_exceptions() == 1);
+		}
+	};
+
+	try
+	{
+		auto const _ = checker{other};
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+	}
+
+	BOOST_TEST(indi::_detail_X_scope::uncaught_exceptions() == 0);
+}
+
+/*****************************************************************************
+ * A fiber that is resumed while the main context is unwinding completes
+ * normally.
+ ****************************************************************************/
+
+namespace {
+
+auto fiber_completes_normally() -> void
+{
+	// Artificial scope
+	{
+		auto const _1 = indi::scope_fail{indi_test::functor_t<int>{fail_count}};
+		auto const _2 = indi::scope_success{indi_test::functor_t<int>{success_count}};
+
+		switch_to(main_context);
+	}
+
+	finish_fiber();
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(fiber_resumed_during_unwinding_CASE_success)
+{
+	reset();
+
+	start_fiber(fiber_completes_normally);
+
+	try
+	{
+		// Resumes the fiber in the middle of unwinding.
+		auto const _ = switch_on_destruction{&fiber_context};
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(fiber_done);
+		BOOST_TEST(fail_count == 0, "scope_fail in fiber saw the main context's exception");
+		BOOST_TEST(success_count == 1, "scope_success in fiber saw the main context's exception");
+	}
+}
+
+/*****************************************************************************
+ * A fiber that switches to the main context in the middle of its own
+ * unwinding doesn't affect the main context's guards, and still detects its
+ * own failure when it is resumed.
+ ****************************************************************************/
+
+namespace {
+
+auto fiber_fails() -> void
+{
+	try
+	{
+		auto const _1 = indi::scope_fail{indi_test::functor_t<int>{fail_count}};
+		auto const _2 = indi::scope_success{indi_test::functor_t<int>{success_count}};
+
+		// Switches to the main context in the middle of unwinding.
+		auto const _3 = switch_on_destruction{&main_context};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+	}
+
+	finish_fiber();
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(fiber_switches_out_during_unwinding_CASE_fail)
+{
+	reset();
+
+	auto main_fail_count = 0;
+	auto main_success_count = 0;
+
+	// Artificial scope
+	{
+		auto const _1 = indi::scope_fail{indi_test::functor_t<int>{main_fail_count}};
+		auto const _2 = indi::scope_success{indi_test::functor_t<int>{main_success_count}};
+
+		// Returns while the fiber is in the middle of unwinding.
+		start_fiber(fiber_fails);
+		BOOST_TEST(not fiber_done);
+		BOOST_TEST(indi::_detail_X_scope::uncaught_exceptions() == 0);
+	}
+
+	BOOST_TEST(main_fail_count == 0, "scope_fail in main context saw the fiber's exception");
+	BOOST_TEST(main_success_count == 1, "scope_success in main context saw the fiber's exception");
+
+	switch_to(fiber_context);
+	BOOST_TEST(fiber_done);
+	BOOST_TEST(fail_count == 1);
+	BOOST_TEST(success_count == 0);
+}
+
+/*****************************************************************************
+ * A scope_checkpoint created in a fiber is relative to the fiber's own
+ * exceptions.
+ ****************************************************************************/
+
+namespace {
+
+auto fiber_checkpoint() -> void
+{
+	auto const checkpoint = indi::scope_checkpoint{};
+	BOOST_TEST(checkpoint.uncaught_on_creation() == 0);
+	BOOST_TEST(not checkpoint.unwinding());
+
+	finish_fiber();
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(checkpoint_in_fiber_started_during_unwinding)
+{
+	reset();
+
+	struct start_on_destruction
+	{
+		~start_on_destruction() { start_fiber(fiber_checkpoint); }
+	};
+
+	try
+	{
+		auto const _ = start_on_destruction{};
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(fiber_done);
+	}
+}
@@ -0,0 +1,108 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+// Compares guard_set against the equivalent array of scope_exit guards.
+//
+// N steps each increment a counter, with a function to decrement it again.
+// Then some of the steps are handed off (every other one, but the compiler
+// can't know which), and their functions released, before the scope exits
+// normally. The guard_set releases them with one mask operation, and its
+// destructor tests each bit of that one mask; the array releases each guard
+// separately, and each destructor checks its own flag.
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.bench.hpp>
+#include <indi/scope.test.hpp>
+
+namespace {
+
+int counter = 0;
+
+// The steps that are handed off. Never changed, but the compiler can't know
+// that.
+volatile std::uint64_t handed_off = 0x5555'5555'5555'5555;
+
+auto step() -> void { ++counter; }
+
+struct undo_t
+{
+	auto operator()() const noexcept -> void { --counter; }
+};
+
+template <int N>
+[[gnu::noinline]] auto guarded_steps() -> void
+{
+	[]<int... Is>(std::integer_sequence<int, Is...>)
+	{
+		(((void)Is, step()), ...);
+		auto guards = std::array{((void)Is, indi::scope_exit{undo_t{}})...};
+
+		auto const mask = handed_off;
+		for (auto i = 0; i < N; ++i)
+		{
+			if (mask & (std::uint64_t{1} << i))
+				guards[i].release();
+		}
+	}(std::make_integer_sequence<int, N>{});
+}
+
+template <int N>
+[[gnu::noinline]] auto guard_set_steps() -> void
+{
+	[]<int... Is>(std::integer_sequence<int, Is...>)
+	{
+		(((void)Is, step()), ...);
+		auto guards = indi::guard_set{((void)Is, undo_t{})...};
+
+		using mask_type = typename decltype(guards)::mask_type;
+		guards.release(static_cast<mask_type>(handed_off));
+	}(std::make_integer_sequence<int, N>{});
+}
+
+/*****************************************************************************
+ * Running and reporting.
+ ****************************************************************************/
+
+template <int N>
+auto run_steps() -> void
+{
+	char name[128];
+	std::snprintf(name, sizeof(name), "guard_set vs scope_exit: %d steps", N);
+
+	indi_bench::report(name,
+		indi_bench::measure(guard_set_steps<N>),
+		indi_bench::measure(guarded_steps<N>));
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+	run_steps<4>();
+	run_steps<16>();
+	run_steps<64>();
+
+	indi_bench::do_not_optimize(counter);
+}
@@ -0,0 +1,325 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#define BOOST_TEST_MODULE guard_set
+#ifdef BOOST_TEST_DYN_LINK
+#	include <boost/test/unit_test.hpp>
+#else
+#	include <boost/test/included/unit_test.hpp>
+#endif // BOOST_TEST_DYN_LINK
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.test.hpp>
+
+namespace {
+
+// Function object that records the order it was called in.
+struct order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	auto operator()() const noexcept { p_order->push_back(id); }
+};
+
+// Like order_functor_t, but copying throws (and moving may throw, so it is
+// copied).
+struct throwing_copy_order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	throwing_copy_order_functor_t(std::vector<int>* p, int i) : p_order{p}, id{i} {}
+	throwing_copy_order_functor_t(throwing_copy_order_functor_t const&) { throw indi_test::exception{}; }
+	throwing_copy_order_functor_t(throwing_copy_order_functor_t&& other) noexcept(false)
+		: p_order{other.p_order}, id{other.id} {}
+
+	auto operator()() const noexcept { p_order->push_back(id); }
+};
+
+// Returns a guard_set with `N` order_functor_t functions, with ids 0 to N-1.
+template <std::size_t N>
+auto make_guard_set(std::vector<int>& order)
+{
+	return [&order]<std::size_t... I>(std::index_sequence<I...>)
+	{
+		return indi::guard_set{order_functor_t{&order, static_cast<int>(I)}...};
+	}(std::make_index_sequence<N>{});
+}
+
+} // anonymous namespace
+
+/*****************************************************************************
+ * Basic operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(basic_operation_CASE_success)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto const _ = indi::guard_set{
+			order_functor_t{&order, 0},
+			order_functor_t{&order, 1},
+			order_functor_t{&order, 2}};
+		BOOST_TEST(order.empty(), "function called before scope exit");
+	}
+
+	BOOST_TEST(order == (std::vector<int>{2, 1, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(basic_operation_CASE_fail)
+{
+	auto order = std::vector<int>{};
+
+	try
+	{
+		auto const _ = indi::guard_set{order_functor_t{&order, 0}, order_functor_t{&order, 1}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(order == (std::vector<int>{1, 0}));
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(basic_operation_WITH_rvalue, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::guard_set{Func{call_count}, Func{call_count}};
+	}
+
+	BOOST_TEST(call_count == 2);
+}
+
+BOOST_AUTO_TEST_CASE(basic_operation_WITH_function_and_reference)
+{
+	indi_test::function_call_count = 0;
+	auto call_count = 0;
+	auto func = indi_test::functor_t<int>{call_count};
+
+	// Artificial scope
+	{
+		auto const _ = indi::guard_set<void (&)(), void (*)(), indi_test::functor_t<int>&>{
+			indi_test::function,
+			&indi_test::function,
+			func};
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 2);
+	BOOST_TEST(call_count == 1);
+}
+
+/*****************************************************************************
+ * Release tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(release_one)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto guards = make_guard_set<4>(order);
+		guards.release<1>();
+		guards.release<3>();
+
+		BOOST_TEST(guards.armed() == 0b0101);
+	}
+
+	BOOST_TEST(order == (std::vector<int>{2, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(release_mask)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto guards = make_guard_set<5>(order);
+		guards.release(0b10110);
+
+		// Releasing again (or releasing bits with no function) does nothing.
+		guards.release(0b11100110);
+
+		BOOST_TEST(guards.armed() == 0b01001);
+	}
+
+	BOOST_TEST(order == (std::vector<int>{3, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(release_all)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto guards = make_guard_set<3>(order);
+		guards.release();
+
+		BOOST_TEST(guards.armed() == 0);
+	}
+
+	BOOST_TEST(order.empty(), "function called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(release_CASE_fail)
+{
+	auto order = std::vector<int>{};
+
+	try
+	{
+		auto guards = make_guard_set<3>(order);
+		guards.release<0>();
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(order == (std::vector<int>{2, 1}));
+	}
+}
+
+// Every bit of the largest mask is used.
+BOOST_AUTO_TEST_CASE(release_WITH_64_functions)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto guards = make_guard_set<64>(order);
+		using guards_t = decltype(guards);
+
+		BOOST_TEST((std::is_same_v<guards_t::mask_type, std::uint_least64_t>));
+		BOOST_TEST(guards_t::all == ~std::uint_least64_t{0});
+		BOOST_TEST(guards.armed() == guards_t::all);
+
+		guards.release(~(guards_t::bit<63> | guards_t::bit<31> | guards_t::bit<0>));
+	}
+
+	BOOST_TEST(order == (std::vector<int>{63, 31, 0}));
+}
+
+/*****************************************************************************
+ * Mask tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(mask_type_and_constants)
+{
+	using guards_3_t = decltype(make_guard_set<3>(std::declval<std::vector<int>&>()));
+	using guards_9_t = decltype(make_guard_set<9>(std::declval<std::vector<int>&>()));
+	using guards_17_t = decltype(make_guard_set<17>(std::declval<std::vector<int>&>()));
+	using guards_33_t = decltype(make_guard_set<33>(std::declval<std::vector<int>&>()));
+
+	BOOST_TEST((std::is_same_v<guards_3_t::mask_type, std::uint_least8_t>));
+	BOOST_TEST((std::is_same_v<guards_9_t::mask_type, std::uint_least16_t>));
+	BOOST_TEST((std::is_same_v<guards_17_t::mask_type, std::uint_least32_t>));
+	BOOST_TEST((std::is_same_v<guards_33_t::mask_type, std::uint_least64_t>));
+
+	BOOST_TEST(guards_3_t::all == 0b111);
+	BOOST_TEST(guards_9_t::all == 0x1FF);
+	BOOST_TEST(guards_3_t::bit<0> == 0b001);
+	BOOST_TEST(guards_3_t::bit<2> == 0b100);
+}
+
+/*****************************************************************************
+ * Move tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(moving)
+{
+	using guards_t = decltype(make_guard_set<3>(std::declval<std::vector<int>&>()));
+	using guards_ptr = std::unique_ptr<guards_t>;
+
+	auto order = std::vector<int>{};
+
+	auto p_guards_1 = guards_ptr{new guards_t{make_guard_set<3>(order)}};
+	p_guards_1->release<1>();
+
+	auto p_guards_2 = guards_ptr{new guards_t{std::move(*p_guards_1)}};
+	BOOST_TEST(order.empty(), "function called by moving guard set");
+	BOOST_TEST(p_guards_1->armed() == 0);
+	BOOST_TEST(p_guards_2->armed() == 0b101);
+
+	p_guards_1.reset();
+	BOOST_TEST(order.empty(), "function called by releasing moved-from guard set");
+
+	p_guards_2.reset();
+	BOOST_TEST(order == (std::vector<int>{2, 0}));
+}
+
+/*****************************************************************************
+ * Init failure tests
+ *
+ * When initializing one of the functions fails, that function argument is
+ * called, then the functions that were already initialized (in reverse
+ * order), like for scope_exit_all.
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(exit_function_called_on_init_failure)
+{
+	auto order = std::vector<int>{};
+
+	BOOST_CHECK_THROW(
+		(indi::guard_set{
+			order_functor_t{&order, 0},
+			order_functor_t{&order, 1},
+			throwing_copy_order_functor_t{&order, 2},
+			order_functor_t{&order, 3}}),
+		indi_test::exception);
+
+	BOOST_TEST(order == (std::vector<int>{2, 1, 0}));
+}
+
+/*****************************************************************************
+ * Special operations
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(size)
+{
+	auto const empty_1 = [] {};
+	auto const empty_2 = [] {};
+	auto const empty_3 = [] {};
+
+	// Empty function objects take no space: the guard set is just its mask.
+	BOOST_TEST(sizeof(indi::guard_set{empty_1, empty_2, empty_3}) == sizeof(std::uint_least8_t));
+}
+
+BOOST_AUTO_TEST_CASE(special_operations)
+{
+	using guards_t = indi::guard_set<indi_test::functor_t<int>, indi_test::move_only_functor_t<int>>;
+
+	BOOST_TEST(not std::is_default_constructible_v<guards_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guards_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guards_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guards_t>);
+	BOOST_TEST(std::is_nothrow_move_constructible_v<guards_t>);
+	BOOST_TEST(std::is_nothrow_destructible_v<guards_t>);
+}
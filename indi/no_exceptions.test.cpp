@@ -0,0 +1,428 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Tests for the exception-free configuration.
+ *
+ * This module is compiled with `-fno-exceptions`, so it can't use
+ * Boost.Test (which needs exceptions). Instead, each test is a function,
+ * and failed checks are counted and reported by `main()`.
+ ****************************************************************************/
+
+#include <cstdio>
+#include <memory>
+#include <system_error>
+#include <type_traits>
+
+#include <indi/scope.hpp>
+#include <indi/transaction.hpp>
+
+#include <indi/scope.test.hpp>
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+#	error "this module must be compiled with exceptions disabled"
+#endif
+
+namespace {
+
+auto failure_count = 0;
+
+// Counts (and reports) a failed check.
+auto check(bool condition, char const* description, int line) -> void
+{
+	if (not condition)
+	{
+		std::printf("no_exceptions.test.cpp(%d): check failed: %s\n", line, description);
+		++failure_count;
+	}
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+/*****************************************************************************
+ * scope_exit
+ ****************************************************************************/
+
+template <typename Func>
+auto scope_exit_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit{Func{call_count}};
+		CHECK(call_count == 0);
+	}
+
+	CHECK(call_count == 1);
+}
+
+template <typename Func>
+auto scope_exit_release() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit{Func{call_count}};
+		scope_guard.release();
+	}
+
+	CHECK(call_count == 0);
+}
+
+template <typename Func>
+auto scope_exit_moving() -> void
+{
+	using scope_exit_ptr = std::unique_ptr<indi::scope_exit<Func>>;
+
+	auto call_count = 0;
+
+	auto p_scope_guard_1 = scope_exit_ptr{new indi::scope_exit{Func{call_count}}};
+	auto p_scope_guard_2 = scope_exit_ptr{new indi::scope_exit{std::move(*p_scope_guard_1)}};
+
+	p_scope_guard_1.reset();
+	CHECK(call_count == 0);
+
+	p_scope_guard_2.reset();
+	CHECK(call_count == 1);
+}
+
+template <typename Func>
+auto scope_exit_all() -> void
+{
+	scope_exit_basic_operation<Func>();
+	scope_exit_release<Func>();
+	scope_exit_moving<Func>();
+}
+
+// Function object with a copy constructor that is not `noexcept`, which
+// would need the function-try-block if exceptions were enabled.
+struct copy_may_throw_t : indi_test::functor_base<int>
+{
+	using indi_test::functor_base<int>::functor_base;
+
+	copy_may_throw_t(copy_may_throw_t const& other) : indi_test::functor_base<int>{other} {}
+
+	auto operator()() const { increment_counter(); }
+};
+
+auto scope_exit_with_copy_may_throw() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const func = copy_may_throw_t{call_count};
+		auto const _ = indi::scope_exit<copy_may_throw_t>{func};
+	}
+
+	CHECK(call_count == 1);
+
+	// Not noexcept, because the copy might (in principle) throw.
+	CHECK((not std::is_nothrow_constructible_v<indi::scope_exit<copy_may_throw_t>, copy_may_throw_t const&>));
+	CHECK((std::is_nothrow_constructible_v<indi::scope_exit<indi_test::functor_t<int>>, indi_test::functor_t<int>>));
+}
+
+/*****************************************************************************
+ * scope_exit_always, scope_exit_fn, scope_exit_assignable, any_scope_exit,
+ * and scope_exit_ref
+ ****************************************************************************/
+
+auto scope_exit_always_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const func = copy_may_throw_t{call_count};
+		auto const _1 = indi::scope_exit_always{indi_test::functor_t<int>{call_count}};
+		auto const _2 = indi::scope_exit_always<copy_may_throw_t>{func};
+	}
+
+	CHECK(call_count == 2);
+}
+
+auto scope_exit_fn_basic_operation() -> void
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _1 = indi::scope_exit_fn<&indi_test::function>{};
+		auto _2 = indi::scope_exit_fn<&indi_test::function>{};
+		_2.release();
+	}
+
+	CHECK(indi_test::function_call_count == 1);
+}
+
+auto scope_exit_assignable_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto _1 = indi::scope_exit_assignable{indi_test::functor_t<int>{call_count}};
+		auto _2 = indi::scope_exit_assignable{indi_test::functor_t<int>{call_count}};
+
+		swap(_1, _2);
+		CHECK(call_count == 0);
+
+		_1 = std::move(_2);
+		CHECK(call_count == 1);
+	}
+
+	CHECK(call_count == 2);
+}
+
+auto scope_exit_all_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit_all{
+			indi_test::functor_t<int>{call_count},
+			indi_test::move_only_functor_t<int>{call_count}};
+	}
+
+	CHECK(call_count == 2);
+}
+
+auto guard_set_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto guards = indi::guard_set{
+			indi_test::functor_t<int>{call_count},
+			indi_test::move_only_functor_t<int>{call_count},
+			indi_test::functor_t<int>{call_count}};
+		guards.release<1>();
+	}
+
+	CHECK(call_count == 2);
+}
+
+auto any_scope_exit_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const func = indi_test::copy_only_functor_t<int>{call_count};
+		auto _1 = indi::any_scope_exit{indi_test::move_only_functor_t<int>{call_count}};
+		auto _2 = indi::any_scope_exit{func};
+
+		_1 = std::move(_2);
+		CHECK(call_count == 1);
+	}
+
+	CHECK(call_count == 2);
+}
+
+auto scope_exit_ref_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto func = indi_test::functor_t<int>{call_count};
+		auto const _1 = indi::scope_exit_ref{func};
+		auto _2 = indi::scope_exit_ref{func};
+		_2.release();
+	}
+
+	CHECK(call_count == 1);
+}
+
+/*****************************************************************************
+ * scope_fail_if and scope_success_if
+ ****************************************************************************/
+
+auto scope_fail_if_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto ec = std::error_code{};
+		auto const _1 = indi::scope_fail_if{ec, indi_test::functor_t<int>{call_count}};
+		auto _2 = indi::scope_fail_if{indi_test::functor_t<int>{call_count}};
+
+		ec = std::make_error_code(std::errc::invalid_argument);
+		_2.fail();
+	}
+
+	CHECK(call_count == 2);
+}
+
+auto scope_success_if_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const func = copy_may_throw_t{call_count};
+		auto ec = std::error_code{};
+		auto const _1 = indi::scope_success_if{ec, indi_test::functor_t<int>{call_count}};
+		auto const _2 = indi::scope_success_if<copy_may_throw_t>{func};
+		auto _3 = indi::scope_success_if{indi_test::functor_t<int>{call_count}};
+
+		_3.fail();
+	}
+
+	CHECK(call_count == 2);
+}
+
+/*****************************************************************************
+ * scope_stack and transaction
+ ****************************************************************************/
+
+auto scope_stack_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		for (auto i = 0; i < 100; ++i)
+			stack.on_exit(indi_test::functor_t<int>{call_count});
+	}
+
+	CHECK(call_count == 100);
+}
+
+auto transaction_basic_operation() -> void
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(indi_test::functor_t<int>{call_count});
+		t.commit();
+		t.on_rollback(indi_test::functor_t<int>{call_count});
+		t.on_rollback(copy_may_throw_t{call_count});
+	}
+
+	CHECK(call_count == 2);
+}
+
+/*****************************************************************************
+ * unique_resource
+ ****************************************************************************/
+
+auto unique_resource_basic_operation() -> void
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::unique_resource{42, indi_test::deleter_t<int>{call_count, last_resource}};
+	}
+
+	CHECK(call_count == 1);
+	CHECK(last_resource == 42);
+}
+
+// Resource with a copy assignment that is not `noexcept`, which would need a
+// try block in reset() if exceptions were enabled.
+struct assign_may_throw_t
+{
+	int value = 0;
+
+	assign_may_throw_t(int v) noexcept : value{v} {}
+	assign_may_throw_t(assign_may_throw_t const&) noexcept = default;
+	auto operator=(assign_may_throw_t const& other) -> assign_may_throw_t& { value = other.value; return *this; }
+};
+
+auto unique_resource_reset_with_assign_may_throw() -> void
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto deleter = [&](assign_may_throw_t r) { ++call_count; last_resource = r.value; };
+		auto resource = indi::unique_resource{assign_may_throw_t{1}, deleter};
+
+		resource.reset(assign_may_throw_t{2});
+		CHECK(call_count == 1);
+		CHECK(last_resource == 1);
+	}
+
+	CHECK(call_count == 2);
+	CHECK(last_resource == 2);
+}
+
+auto make_unique_resource_checked_operation() -> void
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto const _1 = indi::make_unique_resource_checked(7, -1, indi_test::deleter_t<int>{call_count, last_resource});
+		auto const _2 = indi::make_unique_resource_checked(-1, -1, indi_test::deleter_t<int>{call_count, last_resource});
+	}
+
+	CHECK(call_count == 1);
+	CHECK(last_resource == 7);
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+	scope_exit_all<indi_test::functor_t<int>>();
+	scope_exit_all<indi_test::noexcept_functor_t<int>>();
+	scope_exit_all<indi_test::move_only_functor_t<int>>();
+	scope_exit_all<indi_test::copy_only_functor_t<int>>();
+	scope_exit_with_copy_may_throw();
+
+	scope_exit_always_basic_operation();
+	scope_exit_fn_basic_operation();
+	scope_exit_assignable_basic_operation();
+	scope_exit_all_basic_operation();
+	guard_set_basic_operation();
+	any_scope_exit_basic_operation();
+	scope_exit_ref_basic_operation();
+
+	scope_fail_if_basic_operation();
+	scope_success_if_basic_operation();
+
+	scope_stack_basic_operation();
+	transaction_basic_operation();
+
+	unique_resource_basic_operation();
+	unique_resource_reset_with_assign_may_throw();
+	make_unique_resource_checked_operation();
+
+	if (failure_count != 0)
+	{
+		std::printf("*** %d failure(s) detected\n", failure_count);
+		return 1;
+	}
+
+	std::printf("*** No errors detected\n");
+}
@@ -0,0 +1,162 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#ifndef INDI_BENCH_INC_scope
+#define INDI_BENCH_INC_scope
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+#if defined(__x86_64__) or defined(__i386__)
+#	include <x86intrin.h>
+#endif
+
+namespace indi_bench {
+
+/*****************************************************************************
+ * Optimization barriers.
+ ****************************************************************************/
+
+// Forces the compiler to assume the value is read (so the computation that
+// produced it can't be optimized away).
+template <typename T>
+inline auto do_not_optimize(T const& value) -> void
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Forces the compiler to assume all memory may have been read or written.
+inline auto clobber_memory() -> void
+{
+	asm volatile("" : : : "memory");
+}
+
+/*****************************************************************************
+ * Cycle counter.
+ *
+ * On x86, the time stamp counter is used. Everywhere else, there is no
+ * portable cycle counter, so nanoseconds from the steady clock are used
+ * instead (and `cycle_unit` says so).
+ ****************************************************************************/
+
+#if defined(__x86_64__) or defined(__i386__)
+
+inline constexpr auto cycle_unit = "cycles";
+
+inline auto read_cycles() noexcept -> double
+{
+	return static_cast<double>(__rdtsc());
+}
+
+#else
+
+inline constexpr auto cycle_unit = "ns";
+
+inline auto read_cycles() noexcept -> double
+{
+	using ns = std::chrono::duration<double, std::nano>;
+	return std::chrono::duration_cast<ns>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif
+
+/*****************************************************************************
+ * Measurement.
+ ****************************************************************************/
+
+namespace _detail {
+
+// Calls `f` the given number of times, and returns the difference between
+// the values of `now()` before and after.
+template <typename F, typename Now>
+auto run(F& f, long iterations, Now now) -> decltype(now() - now())
+{
+	auto const start = now();
+	for (auto i = 0L; i < iterations; ++i)
+	{
+		f();
+		clobber_memory();
+	}
+	return now() - start;
+}
+
+// Returns the best (lowest) cost per operation of `f`, as measured by
+// `now()`.
+//
+// The number of iterations is calibrated so that each measurement takes at
+// least a few milliseconds, and the best of several measurements is used,
+// to reduce the noise from other processes.
+template <typename F, typename Now>
+auto measure(F& f, Now now) -> double
+{
+	constexpr auto minimum_duration = std::chrono::milliseconds{10};
+	constexpr auto repeats = 7;
+
+	auto iterations = 1L;
+	while (run(f, iterations, std::chrono::steady_clock::now) < minimum_duration)
+		iterations *= 2;
+
+	auto best = std::numeric_limits<double>::max();
+	for (auto i = 0; i < repeats; ++i)
+		best = std::min(best, static_cast<double>(run(f, iterations, now)) / static_cast<double>(iterations));
+
+	return best;
+}
+
+} // namespace _detail
+
+// Returns the time per operation, in nanoseconds, of `f`.
+//
+// `f` is called with no arguments, and should do one operation per call.
+template <typename F>
+auto measure(F&& f) -> double
+{
+	return _detail::measure(f, []
+	{
+		using ns = std::chrono::duration<double, std::nano>;
+		return std::chrono::duration_cast<ns>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	});
+}
+
+// Returns the cost per operation of `f`, in `cycle_unit`s.
+template <typename F>
+auto measure_cycles(F&& f) -> double
+{
+	return _detail::measure(f, read_cycles);
+}
+
+// Prints a single benchmark result.
+inline auto report(char const* name, double ns_per_op) -> void
+{
+	std::printf("%-64s %10.2f ns/op\n", name, ns_per_op);
+}
+
+// Prints a benchmark result next to the result of its baseline (usually the
+// hand-written equivalent), and the ratio between them.
+inline auto report(char const* name, double ns_per_op, double baseline_ns_per_op) -> void
+{
+	std::printf("%-64s %10.2f ns/op %10.2f ns/op (baseline) %6.2fx\n",
+		name, ns_per_op, baseline_ns_per_op, ns_per_op / baseline_ns_per_op);
+}
+
+} // namespace indi_bench
+
+#endif // include guard
@@ -0,0 +1,132 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+// A single use of a single scope guard instantiation, for measuring the
+// object code footprint of that instantiation (see tools/footprint.sh).
+//
+// Compiled once with neither macro defined (the baseline), and once per
+// guard and functor with:
+//      INDI_FOOTPRINT_GUARD    : the scope guard (like `scope_exit`)
+//      INDI_FOOTPRINT_FUNCTOR  : the test functor (like `functor_t`)
+//
+// The functor is not used for the guards with the function as a template
+// argument (like `scope_exit_fn`). The scope_stack and transaction entries
+// are measured as a stack (or transaction) with a single entry, and named
+// like `scope_stack_on_exit` and `transaction_on_rollback`.
+
+#include <indi/scope.hpp>
+#include <indi/scope_stack.hpp>
+#include <indi/transaction.hpp>
+
+#include <indi/scope.test.hpp>
+
+// Defined elsewhere (never, as this is only compiled), so the compiler has
+// to assume it may throw.
+auto work() -> void;
+
+// Also never defined, for the guards with the function as a template
+// argument.
+auto cleanup() noexcept -> void;
+
+int counter = 0;
+
+namespace indi_test {
+
+// Functor with a copy constructor that may throw (declared only), so the
+// guards that call the function if initialization fails need their
+// handlers.
+template <typename T>
+struct throwing_copy_functor_t : functor_base<T>
+{
+	using functor_base<T>::functor_base;
+
+	throwing_copy_functor_t(throwing_copy_functor_t const&);
+
+	auto operator()() const noexcept { functor_base<T>::increment_counter(); }
+
+	auto operator=(throwing_copy_functor_t const&) -> throwing_copy_functor_t& = delete;
+};
+
+} // namespace indi_test
+
+// How each guard is constructed. Guards not listed here take a single
+// functor, like scope_exit.
+#define INDI_FOOTPRINT_KIND_scope_outcome           1
+#define INDI_FOOTPRINT_KIND_scope_exit_all          2
+#define INDI_FOOTPRINT_KIND_scope_fail_all          2
+#define INDI_FOOTPRINT_KIND_scope_success_all       2
+#define INDI_FOOTPRINT_KIND_guard_set               2
+#define INDI_FOOTPRINT_KIND_any_scope_exit          3
+#define INDI_FOOTPRINT_KIND_unique_resource         4
+#define INDI_FOOTPRINT_KIND_scope_exit_fn           5
+#define INDI_FOOTPRINT_KIND_scope_fail_fn           5
+#define INDI_FOOTPRINT_KIND_scope_success_fn        5
+#define INDI_FOOTPRINT_KIND_scope_exit_ref          6
+#define INDI_FOOTPRINT_KIND_scope_fail_ref          6
+#define INDI_FOOTPRINT_KIND_scope_success_ref       6
+#define INDI_FOOTPRINT_KIND_scope_stack_on_exit     7
+#define INDI_FOOTPRINT_KIND_scope_stack_on_fail     8
+#define INDI_FOOTPRINT_KIND_scope_stack_on_success  9
+#define INDI_FOOTPRINT_KIND_transaction_on_rollback 10
+
+#define INDI_FOOTPRINT_CONCAT_(a, b) a##b
+#define INDI_FOOTPRINT_CONCAT(a, b) INDI_FOOTPRINT_CONCAT_(a, b)
+#define INDI_FOOTPRINT_KIND INDI_FOOTPRINT_CONCAT(INDI_FOOTPRINT_KIND_, INDI_FOOTPRINT_GUARD)
+
+auto use() -> void
+{
+#ifdef INDI_FOOTPRINT_GUARD
+#if INDI_FOOTPRINT_KIND == 5
+	auto const _ = indi::INDI_FOOTPRINT_GUARD<&cleanup>{};
+#else
+	using functor = indi_test::INDI_FOOTPRINT_FUNCTOR<int>;
+
+#if INDI_FOOTPRINT_KIND == 1
+	// The outcome is ignored; the lambda is copied like the functor.
+	auto const _ = indi::INDI_FOOTPRINT_GUARD{[f = functor{counter}](indi::outcome) mutable { f(); }};
+#elif INDI_FOOTPRINT_KIND == 2
+	auto const _ = indi::INDI_FOOTPRINT_GUARD<functor, functor>{functor{counter}, functor{counter}};
+#elif INDI_FOOTPRINT_KIND == 3
+	auto const _ = indi::INDI_FOOTPRINT_GUARD<>{functor{counter}};
+#elif INDI_FOOTPRINT_KIND == 4
+	// The functor is the deleter; the resource is ignored.
+	auto const _ = indi::INDI_FOOTPRINT_GUARD{counter, [f = functor{counter}](int) mutable { f(); }};
+#elif INDI_FOOTPRINT_KIND == 6
+	auto f = functor{counter};
+	auto const _ = indi::INDI_FOOTPRINT_GUARD{f};
+#elif INDI_FOOTPRINT_KIND == 7
+	auto stack = indi::scope_stack<>{};
+	stack.on_exit(functor{counter});
+#elif INDI_FOOTPRINT_KIND == 8
+	auto stack = indi::scope_stack<>{};
+	stack.on_fail(functor{counter});
+#elif INDI_FOOTPRINT_KIND == 9
+	auto stack = indi::scope_stack<>{};
+	stack.on_success(functor{counter});
+#elif INDI_FOOTPRINT_KIND == 10
+	auto t = indi::transaction<>{};
+	t.on_rollback(functor{counter});
+#else
+	auto const _ = indi::INDI_FOOTPRINT_GUARD<functor>{functor{counter}};
+#endif
+#endif
+#endif // INDI_FOOTPRINT_GUARD
+
+	work();
+}
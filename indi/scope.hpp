@@ -37,10 +37,82 @@
  * All scope guards also have a `release()` function, that prevents the
  * wrapped function from being called when the guard goes out of scope.
  *
- * Scope guards cannot be copied, and can only be move constructed (not move
- * assigned). They cannot be default constructed, and can only be constructed
- * with a function object or lambda, or a lvalue reference to a function
- * object or lambda, or a lvalue reference to a function.
+ * When both success and failure need handling, scope_outcome calls a single
+ * function with the outcome (`outcome::success` or `outcome::failure`),
+ * instead of using a scope_success and a scope_fail.
+ *
+ * When several scope_fail or scope_success guards are created in a row, they
+ * can share a single scope_checkpoint, so the number of uncaught exceptions
+ * is only checked once on creation:
+ *      auto const checkpoint = scope_checkpoint{};
+ *      auto const s1 = scope_fail{checkpoint, [] { undo_1(); }};
+ *      auto const s2 = scope_fail{checkpoint, [] { undo_2(); }};
+ *
+ * When failures are reported with error codes or `expected`-like results
+ * rather than exceptions, scope_fail_if and scope_success_if decide whether
+ * to call the function from an explicit failure signal (a status object the
+ * guard is bound to, or a call to `fail()`), rather than from the number of
+ * uncaught exceptions:
+ *      auto ec = std::error_code{};
+ *      auto const _ = scope_fail_if{ec, [] { rollback(); }};
+ *
+ * If a scope_exit will never be released or moved, scope_exit_always can be
+ * used instead. It has no `release()` function and is not movable, so it
+ * doesn't need to track whether to call the function.
+ *
+ * When guards with different function types need to have the same type
+ * (to be stored in a container, or a data member), any_scope_exit stores
+ * its function inline in a fixed-size buffer, with its type erased:
+ *      auto guards = std::vector<any_scope_exit<>>{};
+ *      guards.emplace_back([&] { close(fd); });
+ *
+ * To be stored in containers (or reused), scope_exit_assignable,
+ * scope_fail_assignable, and scope_success_assignable are also
+ * move-assignable and swappable. Move-assigning ends the assigned-to guard
+ * as if it went out of scope, then takes over the other's function. With
+ * is_trivially_relocatable, containers can also relocate them with memcpy
+ * (when their functions can be):
+ *      auto guards = std::vector<scope_exit_assignable<on_close>>{};
+ *
+ * For several consecutive guards of the same kind, scope_exit_all,
+ * scope_fail_all, and scope_success_all hold all the functions, with one
+ * flag (or uncaught exception count), and call them in reverse order:
+ *      auto const _ = scope_exit_all{[&] { close(fd); }, [&] { unlink(path); }};
+ *
+ * guard_set is the same as scope_exit_all, but its functions can be
+ * released one by one. The armed state is a bitmask:
+ *      guards.release<0>();     // or guards.release(mask);
+ *
+ * To run the exit function before the end of the scope (to unlock early,
+ * for example), scope_exit, scope_fail, and scope_success have `execute()`,
+ * which calls it now (if the destructor would) and releases the guard. A
+ * released or executed guard can be re-armed with `rearm()`, to reuse it
+ * (in each iteration of a loop, for example):
+ *      auto unlock = scope_exit{[&] { m.unlock(); }};
+ *      // [...]
+ *      unlock.execute();
+ *
+ * When the function lives in the enclosing scope anyway, scope_exit_ref,
+ * scope_fail_ref, and scope_success_ref refer to it rather than storing it,
+ * and are not templates, so there is one guard type (and one destructor)
+ * for every function:
+ *      auto cleanup = [&] { close(fd); };
+ *      auto const _ = scope_exit_ref{cleanup};
+ *
+ * Each of the primary scope guards also has a variant where the function is
+ * a template argument, rather than a constructor argument - scope_exit_fn,
+ * scope_success_fn, and scope_fail_fn - for when the function is known at
+ * compile time:
+ *      auto const _ = scope_exit_fn<&cleanup>{};
+ *
+ * Scope guards cannot be copied, and most can only be move constructed (not
+ * move assigned). The exceptions are scope_exit_assignable,
+ * scope_fail_assignable, scope_success_assignable, and any_scope_exit,
+ * which can also be move assigned, and scope_exit_always, which can't be
+ * moved at all. (unique_resource, below, can also be move assigned.) Scope
+ * guards cannot be default constructed, and can only be constructed with a
+ * function object or lambda, or a lvalue reference to a function object or
+ * lambda, or a lvalue reference to a function.
  *
  * Usage:
  *      auto f()
@@ -95,6 +167,35 @@
  * Specific scope guards may have additional or slightly modified
  * requirements.
  *
+ * Configuration:
+ *      *   INDI_SCOPE_FAST_UNCAUGHT_EXCEPTIONS
+ *              If defined (before including this header), scope_fail,
+ *              scope_success, scope_outcome, and scope_checkpoint read the
+ *              number of uncaught exceptions directly from the C++ runtime's
+ *              per-thread exception globals, rather than calling
+ *              `std::uncaught_exceptions()`. Only supported on targets that
+ *              use the Itanium C++ ABI (GCC and Clang everywhere except
+ *              MSVC targets); elsewhere `std::uncaught_exceptions()` is
+ *              still used.
+ *      *   INDI_SCOPE_EXCEPTION_CONTEXTS
+ *              If defined, the number of uncaught exceptions used by the
+ *              guards that detect stack unwinding is counted per
+ *              exception_context rather than per thread, so that user-level
+ *              fibers that switch in the middle of stack unwinding don't
+ *              see each other's exceptions. Fiber libraries must call
+ *              switch_exception_context() on every switch.
+ *      *   INDI_SCOPE_NO_EXCEPTIONS
+ *              If defined, or if exceptions are disabled (like with
+ *              `-fno-exceptions`), the header is usable without exceptions.
+ *              scope_exit (and its `_always`, `_fn`, `_ref`, `_assignable`,
+ *              and `_all` variants), guard_set, any_scope_exit,
+ *              scope_fail_if, scope_success_if, and unique_resource work as
+ *              usual, but without any try/catch. scope_fail and
+ *              scope_success (and their `_fn`, `_ref`, `_assignable`, and
+ *              `_all` variants), scope_outcome, and scope_checkpoint are
+ *              unavailable, because there is no stack unwinding for them to
+ *              detect: using them fails with a static assertion.
+ *
  * This header is based on the proposed extension to the C++ standard library
  * P0052.
  *
@@ -103,15 +204,101 @@
  *
  ****************************************************************************/
 
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 
+#if defined(INDI_SCOPE_NO_EXCEPTIONS) \
+	or not (defined(__cpp_exceptions) or defined(__EXCEPTIONS) or defined(_CPPUNWIND))
+#	define INDI_X_SCOPE_NO_EXCEPTIONS
+#endif
+
+#if defined(INDI_SCOPE_FAST_UNCAUGHT_EXCEPTIONS) and defined(__GXX_ABI_VERSION)
+#	if __has_include(<cxxabi.h>)
+#		include <cxxabi.h>
+#		define INDI_X_SCOPE_ITANIUM_UNCAUGHT_EXCEPTIONS
+#	endif
+#endif
+
 namespace indi {
 inline namespace v1 {
 
 namespace _detail_X_scope {
 
+// runtime_uncaught_exceptions()
+//
+// Same as `std::uncaught_exceptions()`, except that if the fast path is
+// enabled (see INDI_SCOPE_FAST_UNCAUGHT_EXCEPTIONS), the count is read
+// directly from the runtime's per-thread exception globals.
+//
+// `__cxa_get_globals()` returns the same pointer for the whole life of the
+// thread, so it is only called the first time on each thread. After that,
+// the count is a load through a thread-local pointer.
+#ifdef INDI_X_SCOPE_ITANIUM_UNCAUGHT_EXCEPTIONS
+
+inline constexpr auto has_fast_uncaught_exceptions = true;
+
+// The leading members of `__cxa_eh_globals`, as specified by the Itanium
+// C++ ABI (section 2.2.2).
+struct eh_globals
+{
+	void* caught_exceptions;
+	unsigned int uncaught_exceptions;
+};
+
+inline thread_local eh_globals* p_eh_globals = nullptr;
+
+inline auto runtime_uncaught_exceptions() noexcept -> int
+{
+	auto p = p_eh_globals;
+	if (p == nullptr) [[unlikely]]
+		p_eh_globals = p = reinterpret_cast<eh_globals*>(abi::__cxa_get_globals());
+
+	return static_cast<int>(p->uncaught_exceptions);
+}
+
+#else
+
+inline constexpr auto has_fast_uncaught_exceptions = false;
+
+inline auto runtime_uncaught_exceptions() noexcept -> int
+{
+	return std::uncaught_exceptions();
+}
+
+#endif // INDI_X_SCOPE_ITANIUM_UNCAUGHT_EXCEPTIONS
+
+// uncaught_exceptions()
+//
+// The number of uncaught exceptions in the current exception context: the
+// runtime's count for the thread, or if exception contexts are enabled (see
+// INDI_SCOPE_EXCEPTION_CONTEXTS), only the exceptions thrown since the
+// current context was switched in (plus the ones it had when it was
+// switched out).
+#ifdef INDI_SCOPE_EXCEPTION_CONTEXTS
+
+inline thread_local int uncaught_exceptions_offset = 0;
+
+inline auto uncaught_exceptions() noexcept -> int
+{
+	return runtime_uncaught_exceptions() - uncaught_exceptions_offset;
+}
+
+#else
+
+// (A reference rather than a wrapper, so there is no extra call when it is
+// not inlined.)
+inline constexpr auto& uncaught_exceptions = runtime_uncaught_exceptions;
+
+#endif // INDI_SCOPE_EXCEPTION_CONTEXTS
+
 // move_init_if_noexcept<T, U>(U&&)
 //
 // Works almost identically to `std::forward<U>(u)`, except that if
@@ -148,17 +335,47 @@ constexpr auto move_init_if_noexcept(U& u) noexcept -> decltype(auto)
 	}
 }
 
-// scope_guard_base<EF>
+// is_nothrow_exit_function_init_v<EF, EFP>
+//
+// Whether initializing an `EF` with `move_init_if_noexcept<EF, EFP>(f)` is
+// guaranteed not to throw. (That's the case if the move-construct is
+// noexcept, because it will be used, or if the copy-construct is noexcept,
+// because it will be used otherwise.)
+//
+// Scope guard constructors use this (via needs_init_failure_handler_v) to
+// select an overload without the function-try-block that calls the exit
+// function if initialization fails, so no landing pad or exception table
+// entry is generated when it could never be used.
+template <typename EF, typename EFP>
+inline constexpr auto is_nothrow_exit_function_init_v =
+	std::is_nothrow_constructible_v<EF, EFP> or std::is_nothrow_constructible_v<EF, EFP&>;
+
+// needs_init_failure_handler_v<EF, EFP>
+//
+// Whether a scope guard constructor needs the function-try-block: only if
+// initializing the exit function may throw, and exceptions are enabled.
+template <typename EF, typename EFP>
+inline constexpr auto needs_init_failure_handler_v =
+#ifdef INDI_X_SCOPE_NO_EXCEPTIONS
+	false;
+#else
+	not is_nothrow_exit_function_init_v<EF, EFP>;
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+
+// scope_guard_base<EF, Args...>
 //
 // Base type for scope guards, to set up some sensible defaults and avoid
 // repetition.
-template <typename EF>
+//
+// `Args...` are the types of the arguments the exit function is called with
+// (for the standard scope guards, there are none).
+template <typename EF, typename... Args>
 class scope_guard_base
 {
 public:
 	// 7.5.2.3 requirements.
 	static_assert((std::is_object_v<EF> and std::is_destructible_v<EF>) or std::is_lvalue_reference_v<EF>);
-	static_assert(std::is_invocable_v<std::remove_reference_t<EF>>);
+	static_assert(std::is_invocable_v<std::remove_reference_t<EF>, Args...>);
 
 	// Scope guards are move constructible.
 	constexpr scope_guard_base(scope_guard_base&&) noexcept = default;
@@ -178,8 +395,161 @@ protected:
 	constexpr scope_guard_base() noexcept = default;
 };
 
+// exit_function_storage<EF>
+//
+// Holds the exit function of a scope guard along with whether it should be
+// called (whether the guard is "armed").
+//
+// In general, that's an `EF` and a `bool`. But if `EF` is a reference or
+// a function pointer, the function is stored as a pointer, and a null
+// pointer means "disarmed". That makes the storage exactly the size of a
+// pointer, rather than a pointer and a (padded) `bool`.
+template <typename EF>
+inline constexpr auto is_nullable_exit_function_v =
+	std::is_lvalue_reference_v<EF>
+	or (std::is_pointer_v<EF> and std::is_function_v<std::remove_pointer_t<EF>>);
+
+template <typename EF>
+class exit_function_storage
+{
+public:
+	template <typename EFP>
+	constexpr explicit exit_function_storage(EFP&& f)
+		noexcept(std::is_nothrow_constructible_v<EF, EFP>)
+	:
+		_function{std::forward<EFP>(f)}
+	{}
+
+	constexpr exit_function_storage(exit_function_storage&& other)
+		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
+	:
+		_function{move_init_if_noexcept<EF, EF&&>(other._function)},
+		_armed{other._armed}
+	{}
+
+	constexpr auto is_armed() const noexcept -> bool { return _armed; }
+
+	constexpr auto disarm() noexcept -> void { _armed = false; }
+
+	constexpr auto arm() noexcept -> void { _armed = true; }
+
+	constexpr auto operator()() noexcept(noexcept(std::declval<EF&>()())) -> void { _function(); }
+
+	// If armed, disarms, then calls the function.
+	constexpr auto execute() noexcept(noexcept(std::declval<EF&>()())) -> void
+	{
+		if (_armed)
+		{
+			_armed = false;
+			_function();
+		}
+	}
+
+private:
+	EF _function;
+	bool _armed = true;
+};
+
+template <typename EF>
+	requires is_nullable_exit_function_v<EF>
+class exit_function_storage<EF>
+{
+public:
+	using pointer = std::conditional_t<std::is_lvalue_reference_v<EF>, std::remove_reference_t<EF>*, EF>;
+
+	template <typename EFP>
+	constexpr explicit exit_function_storage(EFP&& f) noexcept
+	{
+		if constexpr (std::is_lvalue_reference_v<EF>)
+		{
+			EF ref = std::forward<EFP>(f);
+			_p_function = std::addressof(ref);
+		}
+		else
+		{
+			_p_function = static_cast<EF>(std::forward<EFP>(f));
+		}
+	}
+
+	constexpr exit_function_storage(exit_function_storage&& other) noexcept :
+		_p_function{other._p_function}
+	{}
+
+	constexpr auto is_armed() const noexcept -> bool { return _p_function != nullptr; }
+
+	constexpr auto disarm() noexcept -> void { _p_function = nullptr; }
+
+	constexpr auto operator()() noexcept(noexcept(std::declval<EF&>()())) -> void { (*_p_function)(); }
+
+	// If armed, disarms, then calls the function. (The disarmed state is a
+	// null pointer, so this can't be re-armed.)
+	constexpr auto execute() noexcept(noexcept(std::declval<EF&>()())) -> void
+	{
+		if (auto const p_function = std::exchange(_p_function, nullptr))
+			(*p_function)();
+	}
+
+private:
+	pointer _p_function = nullptr;
+};
+
 } // namespace _detail_X_scope
 
+#ifdef INDI_SCOPE_EXCEPTION_CONTEXTS
+
+// exception_context
+//
+// The number of uncaught exceptions for a user-level execution context (a
+// fiber, or the thread's own context), so that scope guards in one context
+// don't see exceptions that are being thrown in another.
+//
+// The C++ runtime only counts uncaught exceptions per OS thread. If a fiber
+// switches to another in the middle of stack unwinding (in a destructor),
+// the other fiber sees that exception too, and its scope_fail and
+// scope_success guards misfire. To prevent that, each context (including the
+// thread's original one) should have an exception_context, and the fiber
+// library should call switch_exception_context() on every switch:
+//      switch_exception_context(from->exceptions, to->exceptions);
+//      swapcontext(&from->context, &to->context);
+//
+// A new exception_context has no uncaught exceptions. It must not be
+// destroyed while it is switched in.
+class exception_context
+{
+public:
+	constexpr exception_context() noexcept = default;
+
+	exception_context(exception_context const&) = delete;
+	auto operator=(exception_context const&) -> exception_context& = delete;
+
+	// The number of uncaught exceptions in this context, when it was last
+	// switched out.
+	constexpr auto uncaught_when_switched_out() const noexcept -> int
+	{
+		return _uncaught_exceptions;
+	}
+
+private:
+	friend auto switch_exception_context(exception_context&, exception_context&) noexcept -> void;
+
+	int _uncaught_exceptions = 0;
+};
+
+// switch_exception_context(from, to)
+//
+// Switches the current thread from the exception context `from` (which must
+// be the current one) to `to`. Call it just before switching execution
+// contexts.
+inline auto switch_exception_context(exception_context& from, exception_context& to) noexcept -> void
+{
+	auto const runtime_count = _detail_X_scope::runtime_uncaught_exceptions();
+
+	from._uncaught_exceptions = runtime_count - _detail_X_scope::uncaught_exceptions_offset;
+	_detail_X_scope::uncaught_exceptions_offset = runtime_count - to._uncaught_exceptions;
+}
+
+#endif // INDI_SCOPE_EXCEPTION_CONTEXTS
+
 // scope_exit<EF>
 //
 // scope_exit is a scope guard that calls its contained function whenever the
@@ -189,16 +559,41 @@ protected:
 // Extra requirements (in addition to basic scope guard requirements):
 //      *   If `g` is an instance of `remove_reference_t<EF>`, `g()` should
 //          not raise an exception.
+//
+// If `EF` is a reference or function pointer type, the released state is
+// stored as a null pointer rather than a separate flag, so
+// `sizeof(scope_exit<EF>) == sizeof(void*)`. Releasing such a guard drops
+// the function, so it can't be re-armed: `rearm()` is deleted. That
+// includes `scope_exit{&f}`, which deduces a function pointer; use
+// `scope_exit{[] { f(); }}` for a guard that can be re-armed.
+//
+// `rearm()` must not be called on a moved-from guard. The moved-from state
+// is not tracked separately from the released state, so this is not
+// checked: the destructor would call the moved-from function.
 template <typename EF>
 class scope_exit : public _detail_X_scope::scope_guard_base<EF>
 {
 public:
+	// If initializing the exit function can't throw (or exceptions are
+	// disabled), there is no need for the function-try-block (and its
+	// landing pad).
+	template <typename EFP>
+		requires (not _detail_X_scope::needs_init_failure_handler_v<EF, EFP>)
+	explicit scope_exit(EFP&& f)
+		noexcept(_detail_X_scope::is_nothrow_exit_function_init_v<EF, EFP>)
+	:
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)}
+	{
+		// 7.5.2.5 requirements.
+		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_exit>);
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
 	template <typename EFP>
 	explicit scope_exit(EFP&& f)
-		noexcept(std::is_nothrow_constructible_v<EF, EFP> or std::is_nothrow_constructible_v<EF, EFP&>)
 	try :
-		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)},
-		_execute_on_destruction{true}
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)}
 	{
 		// 7.5.2.5 requirements.
 		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_exit>);
@@ -208,142 +603,2623 @@ public:
 	{
 		f();
 	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
 
 	scope_exit(scope_exit&& other)
 		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
 	:
-		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EF&&>(other._exit_function)},
-		_execute_on_destruction{other._execute_on_destruction}
+		_exit_function{std::move(other._exit_function)}
 	{
 		other.release();
 	}
 
 	~scope_exit()
 	{
-		if (_execute_on_destruction)
+		if (_exit_function.is_armed())
 			_exit_function();
 	}
 
 	auto release() noexcept -> void
 	{
-		_execute_on_destruction = false;
+		_exit_function.disarm();
 	}
 
+	// Calls the exit function now, unless the guard was released, and
+	// releases the guard (before the call, so even if the function throws,
+	// the destructor won't call it again).
+	auto execute() noexcept(noexcept(_exit_function())) -> void
+	{
+		_exit_function.execute();
+	}
+
+	// Re-arms a released (or executed) guard, so the exit function will be
+	// called on destruction again. Must not be used on a moved-from guard.
+	auto rearm() noexcept -> void
+		requires (not _detail_X_scope::is_nullable_exit_function_v<EF>)
+	{
+		_exit_function.arm();
+	}
+
+	// Deleted if `EF` is a reference or function pointer type, because
+	// releasing the guard dropped the function (see the class comment).
+	auto rearm() noexcept -> void
+		requires _detail_X_scope::is_nullable_exit_function_v<EF>
+	= delete;
+
 private:
-	EF _exit_function;
-	bool _execute_on_destruction = true;
+	_detail_X_scope::exit_function_storage<EF> _exit_function;
 };
 
 template <typename EF>
 scope_exit(EF) -> scope_exit<EF>;
 
-// scope_fail<EF>
+// scope_exit_always<EF>
 //
-// scope_fail is a scope guard that calls its contained function only in
-// the case that it is destroyed during stack unwinding.
+// scope_exit_always is a scope guard that unconditionally calls its
+// contained function when the scope exits. Unlike scope_exit, it cannot be
+// released or moved, so it needs no "execute on destruction" flag, and its
+// destructor is just the call.
+//
+// Because of guaranteed copy elision, it can still be initialized with the
+// usual syntax:
+//      auto const _ = scope_exit_always{[] { std::cout << "exit!"; }};
+//
+// Extra requirements (in addition to basic scope guard requirements):
+//      *   If `g` is an instance of `remove_reference_t<EF>`, `g()` should
+//          not raise an exception.
 template <typename EF>
-class scope_fail : public _detail_X_scope::scope_guard_base<EF>
+class scope_exit_always : public _detail_X_scope::scope_guard_base<EF>
 {
 public:
 	template <typename EFP>
-	explicit scope_fail(EFP&& f)
-		noexcept(std::is_nothrow_constructible_v<EF, EFP> or std::is_nothrow_constructible_v<EF, EFP&>)
+		requires (not _detail_X_scope::needs_init_failure_handler_v<EF, EFP>)
+	explicit scope_exit_always(EFP&& f)
+		noexcept(_detail_X_scope::is_nothrow_exit_function_init_v<EF, EFP>)
+	:
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)}
+	{
+		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_exit_always>);
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+	template <typename EFP>
+	explicit scope_exit_always(EFP&& f)
 	try :
-		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)},
-		_uncaught_on_creation{std::uncaught_exceptions()}
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)}
 	{
-		// 7.5.2.10 requirements.
-		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_fail>);
+		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_exit_always>);
 		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
 	}
 	catch (...)
 	{
 		f();
 	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
 
-	scope_fail(scope_fail&& other)
-		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
-	:
-		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EF&&>(other._exit_function)},
-		_uncaught_on_creation{other._uncaught_on_creation}
+	~scope_exit_always()
+	{
+		_exit_function();
+	}
+
+	// Not movable.
+	scope_exit_always(scope_exit_always&&) = delete;
+
+private:
+	EF _exit_function;
+};
+
+template <typename EF>
+scope_exit_always(EF) -> scope_exit_always<EF>;
+
+// scope_exit_fn<F>
+//
+// scope_exit_fn is the same as scope_exit, except that the exit function is
+// a template argument (usually a pointer to a function), rather than a data
+// member. It stores only the "execute on destruction" flag, and the call in
+// the destructor is a direct call that can be inlined.
+//
+// Usage:
+//      auto const _ = scope_exit_fn<&unlink_tmp>{};
+//
+// Requirements:
+//      *   `F()` should be well-formed, and should not raise an exception.
+template <auto F>
+class scope_exit_fn : public _detail_X_scope::scope_guard_base<decltype(F)>
+{
+public:
+	constexpr scope_exit_fn() noexcept = default;
+
+	constexpr scope_exit_fn(scope_exit_fn&& other) noexcept :
+		_execute_on_destruction{other._execute_on_destruction}
 	{
 		other.release();
 	}
 
-	~scope_fail()
+	~scope_exit_fn()
 	{
-		if (std::uncaught_exceptions() > _uncaught_on_creation)
-			_exit_function();
+		if (_execute_on_destruction)
+			F();
 	}
 
-	auto release() noexcept -> void
+	constexpr auto release() noexcept -> void
 	{
-		// The number of uncaught exceptions can never be greater than the
-		// max value of int, so by setting the count to this, the destructor
-		// condition can never be met.
-		_uncaught_on_creation = std::numeric_limits<int>::max();
+		_execute_on_destruction = false;
 	}
 
 private:
-	EF _exit_function;
-	int _uncaught_on_creation = 0;
+	bool _execute_on_destruction = true;
 };
 
+// is_trivially_relocatable<T>
+//
+// Whether an object of type `T` can be relocated - moved to a new address,
+// with the original's lifetime ended without calling its destructor - by
+// copying its bytes (for example, with `std::memcpy()`), so containers can
+// move their elements in bulk.
+//
+// By default, that's only the case for trivially copyable types. Other
+// types can opt in by specializing this template; it is specialized for the
+// assignable scope guards, so they are trivially relocatable whenever their
+// exit functions are (or are references).
+template <typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+inline constexpr auto is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace _detail_X_scope {
+
+// Whether a scope guard holding an `EF` is trivially relocatable: if the
+// function is stored as a pointer, or is itself trivially relocatable.
 template <typename EF>
-scope_fail(EF) -> scope_fail<EF>;
+inline constexpr auto is_trivially_relocatable_exit_function_v =
+	std::is_lvalue_reference_v<EF> or is_trivially_relocatable_v<EF>;
 
-// scope_success<EF>
+// Move-assigns the scope guard `other` to `guard`: `guard` is destroyed
+// (so its exit function is called if it would have been called when it
+// went out of scope), then move-constructed from `other`.
 //
-// scope_success is a scope guard that calls its contained function only in
-// the case that it is destroyed under normal conditions (not stack
-// unwinding).
+// Destroying and re-creating the whole object is only valid if it is not
+// potentially-overlapping (a base class subobject, or a
+// [[no_unique_address]] member), so the guards that use this are `final`,
+// and must not be [[no_unique_address]] members.
+//
+// `other` is moved out of the way first, so that `guard` is move-constructed
+// even if its exit function throws.
+template <typename Guard>
+auto move_assign_scope_guard(Guard& guard, Guard& other)
+	noexcept(std::is_nothrow_destructible_v<Guard>) -> void
+{
+	if (std::addressof(guard) == std::addressof(other))
+		return;
+
+	auto moved = Guard{std::move(other)};
+	auto const _ = scope_exit_always{[&guard, &moved]() noexcept
+	{
+		std::construct_at(std::addressof(guard), std::move(moved));
+	}};
+
+	std::destroy_at(std::addressof(guard));
+}
+
+// Swaps the scope guards `a` and `b`. Neither exit function is called.
+template <typename Guard>
+auto swap_scope_guards(Guard& a, Guard& b) noexcept -> void
+{
+	if (std::addressof(a) == std::addressof(b))
+		return;
+
+	// Both guards are released by being moved from, so destroying them
+	// calls nothing.
+	auto moved_a = Guard{std::move(a)};
+	auto moved_b = Guard{std::move(b)};
+
+	std::destroy_at(std::addressof(a));
+	std::construct_at(std::addressof(a), std::move(moved_b));
+	std::destroy_at(std::addressof(b));
+	std::construct_at(std::addressof(b), std::move(moved_a));
+}
+
+} // namespace _detail_X_scope
+
+// scope_exit_assignable<EF>
+//
+// scope_exit_assignable is a scope_exit that is also move-assignable and
+// swappable, so it can be stored in containers, and reused.
+//
+// Move-assigning ends the assigned-to guard, as if it went out of scope
+// (so its function is called, unless it was released or moved from), then
+// takes over the other guard's function and state (and releases the other
+// guard). To replace a guard without calling its function, release it
+// first. Swapping calls neither function.
+//
+// Assigning and swapping re-create the whole guard, so it is `final`, and
+// must not be a [[no_unique_address]] member.
+//
+// Extra requirements (in addition to scope_exit requirements):
+//      *   std::is_nothrow_move_constructible_v<EF>
+//              or std::is_nothrow_copy_constructible_v<EF>
 template <typename EF>
-class scope_success : public _detail_X_scope::scope_guard_base<EF>
+class scope_exit_assignable final : public scope_exit<EF>
 {
+	static_assert(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>,
+		"assignable scope guards need a function that is nothrow move or copy constructible");
+
 public:
-	template <typename EFP>
-	explicit scope_success(EFP&& f)
-		noexcept(std::is_nothrow_constructible_v<EF, EFP> or std::is_nothrow_constructible_v<EF, EFP&>)
-	:
-		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)},
-		_uncaught_on_creation{std::uncaught_exceptions()}
-	{
-		// 7.5.2.15 requirements.
-		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_success>);
-		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
-	}
+	using scope_exit<EF>::scope_exit;
 
-	scope_success(scope_success&& other)
-		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
-	:
-		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EF&&>(other._exit_function)},
-		_uncaught_on_creation{other._uncaught_on_creation}
+	scope_exit_assignable(scope_exit_assignable&&) noexcept = default;
+
+	auto operator=(scope_exit_assignable&& other) noexcept -> scope_exit_assignable&
 	{
-		other.release();
+		_detail_X_scope::move_assign_scope_guard(*this, other);
+		return *this;
 	}
 
-	~scope_success()
-		noexcept(noexcept(_exit_function()))
+	auto swap(scope_exit_assignable& other) noexcept -> void
 	{
-		if (std::uncaught_exceptions() <= _uncaught_on_creation)
-			_exit_function();
+		_detail_X_scope::swap_scope_guards(*this, other);
 	}
 
-	auto release() noexcept -> void
+	friend auto swap(scope_exit_assignable& a, scope_exit_assignable& b) noexcept -> void
 	{
-		// The number of uncaught exceptions can never be less than zero,
-		// so by setting the count to -1, the destructor condition can never
-		// be met.
-		_uncaught_on_creation = -1;
+		a.swap(b);
 	}
-
-private:
-	EF _exit_function;
-	int _uncaught_on_creation = 0;
 };
 
 template <typename EF>
-scope_success(EF) -> scope_success<EF>;
+scope_exit_assignable(EF) -> scope_exit_assignable<EF>;
+
+template <typename EF>
+struct is_trivially_relocatable<scope_exit_assignable<EF>>
+	: std::bool_constant<_detail_X_scope::is_trivially_relocatable_exit_function_v<EF>> {};
+
+namespace _detail_X_scope {
+
+// exit_function_pack<CallOnFailure, std::index_sequence<I...>, EF...>
+//
+// The exit functions of a scope guard with several functions
+// (scope_exit_all, scope_fail_all, and scope_success_all). Each function is
+// in its own base class, so empty function objects take no space.
+//
+// The functions are initialized in order. If initializing one fails, and
+// `CallOnFailure` is true, the function argument it was initialized from is
+// called, then the functions that were already initialized are called in
+// reverse order - the same as for a sequence of single scope guards.
+template <bool CallOnFailure, typename Indices, typename... EF>
+class exit_function_pack;
+
+template <bool CallOnFailure, std::size_t I, typename EF, typename Pack>
+class exit_function_pack_element
+{
+public:
+	template <typename EFP>
+		requires (not (CallOnFailure and needs_init_failure_handler_v<EF, EFP>))
+	constexpr exit_function_pack_element(EFP&& f, Pack&)
+		noexcept(is_nothrow_exit_function_init_v<EF, EFP>)
+	:
+		_function{move_init_if_noexcept<EF, EFP>(f)}
+	{}
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+	template <typename EFP>
+		requires (CallOnFailure and needs_init_failure_handler_v<EF, EFP>)
+	exit_function_pack_element(EFP&& f, Pack& pack)
+	try :
+		_function{move_init_if_noexcept<EF, EFP>(f)}
+	{}
+	catch (...)
+	{
+		f();
+		call_exit_functions<I>(pack);
+	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+
+	constexpr exit_function_pack_element(exit_function_pack_element&& other)
+		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
+	:
+		_function{move_init_if_noexcept<EF, EF&&>(other._function)}
+	{}
+
+	constexpr auto operator()() noexcept(noexcept(std::declval<EF&>()())) -> void { _function(); }
+
+private:
+	[[no_unique_address]] EF _function;
+};
+
+// Returns the element of an exit_function_pack with index `I`.
+template <std::size_t I, bool CallOnFailure, typename EF, typename Pack>
+constexpr auto get_exit_function(exit_function_pack_element<CallOnFailure, I, EF, Pack>& element) noexcept
+	-> exit_function_pack_element<CallOnFailure, I, EF, Pack>&
+{
+	return element;
+}
+
+// Calls the first `N` functions of `pack`, in reverse order.
+//
+// This is not a member function, because it is also used while the pack is
+// being constructed (when only the conversion to its base classes that are
+// already constructed is allowed).
+template <std::size_t N, typename Pack>
+constexpr auto call_exit_functions(Pack& pack) -> void
+{
+	[&pack]<std::size_t... J>(std::index_sequence<J...>)
+	{
+		(get_exit_function<N - 1 - J>(pack)(), ...);
+	}(std::make_index_sequence<N>{});
+}
+
+template <bool CallOnFailure, std::size_t... I, typename... EF>
+class exit_function_pack<CallOnFailure, std::index_sequence<I...>, EF...> :
+	public exit_function_pack_element<
+		CallOnFailure, I, EF, exit_function_pack<CallOnFailure, std::index_sequence<I...>, EF...>>...
+{
+public:
+	// Whether calling all the functions can't throw.
+	static constexpr auto nothrow_invocable = (std::is_nothrow_invocable_v<EF&> and ...);
+
+	template <typename... EFP>
+		requires (sizeof...(EFP) == sizeof...(EF))
+	constexpr explicit exit_function_pack(EFP&&... fs)
+		noexcept((is_nothrow_exit_function_init_v<EF, EFP> and ...))
+	:
+		exit_function_pack_element<CallOnFailure, I, EF, exit_function_pack>(std::forward<EFP>(fs), *this)...
+	{}
+
+	constexpr exit_function_pack(exit_function_pack&&) = default;
+
+	// Calls all the functions, in reverse order.
+	constexpr auto operator()() noexcept(nothrow_invocable) -> void
+	{
+		call_exit_functions<sizeof...(EF)>(*this);
+	}
+};
+
+// Whether the arguments to a scope guard with `N` functions are the
+// functions (and not another guard of the same type, `Guard`, to move).
+template <typename Guard, std::size_t N, typename... EFP>
+inline constexpr auto is_exit_function_pack_init_v =
+	sizeof...(EFP) == N and not (std::is_same_v<std::remove_cvref_t<EFP>, Guard> or ...);
+
+} // namespace _detail_X_scope
+
+// scope_exit_all<EF...>
+//
+// scope_exit_all is a scope guard for several exit functions, that calls
+// them all, in reverse order, whenever the scope exits - the same as a
+// sequence of scope_exit guards, one per function:
+//      auto const _ = scope_exit_all{
+//          [&] { close(fd); },
+//          [&] { unlink(path); },
+//          [&] { log("done"); }};
+//      // Calls log(), then unlink(), then close().
+//
+// Unlike a sequence of guards, the functions share a single "execute on
+// destruction" flag (so they are released, executed, and re-armed
+// together), and the destructor only checks it once. Empty function
+// objects take no space.
+//
+// If initializing one of the functions fails, the function argument is
+// called (like for scope_exit), then the functions that were already
+// initialized are called in reverse order, before the exception is
+// propagated; the ones after it are not called.
+//
+// Extra requirements (in addition to scope_exit requirements, for each
+// `EF`):
+//      *   sizeof...(EF) > 0
+template <typename... EF>
+class scope_exit_all
+{
+	using functions_type = _detail_X_scope::exit_function_pack<true, std::index_sequence_for<EF...>, EF...>;
+
+public:
+	static_assert(sizeof...(EF) > 0);
+	static_assert((((std::is_object_v<EF> and std::is_destructible_v<EF>) or std::is_lvalue_reference_v<EF>) and ...));
+	static_assert((std::is_invocable_v<std::remove_reference_t<EF>> and ...));
+
+	template <typename... EFP>
+		requires _detail_X_scope::is_exit_function_pack_init_v<scope_exit_all, sizeof...(EF), EFP...>
+	explicit scope_exit_all(EFP&&... fs)
+		noexcept(std::is_nothrow_constructible_v<functions_type, EFP...>)
+	:
+		_functions(std::forward<EFP>(fs)...)
+	{}
+
+	scope_exit_all(scope_exit_all&& other)
+		noexcept(std::is_nothrow_move_constructible_v<functions_type>)
+	:
+		_functions(std::move(other._functions)),
+		_execute_on_destruction{other._execute_on_destruction}
+	{
+		other.release();
+	}
+
+	~scope_exit_all()
+	{
+		if (_execute_on_destruction)
+			_functions();
+	}
+
+	auto release() noexcept -> void
+	{
+		_execute_on_destruction = false;
+	}
+
+	// See scope_exit::execute().
+	auto execute() noexcept(functions_type::nothrow_invocable) -> void
+	{
+		if (_execute_on_destruction)
+		{
+			_execute_on_destruction = false;
+			_functions();
+		}
+	}
+
+	// See scope_exit::rearm().
+	auto rearm() noexcept -> void
+	{
+		_execute_on_destruction = true;
+	}
+
+	scope_exit_all(scope_exit_all const&) = delete;
+	auto operator=(scope_exit_all const&) -> scope_exit_all& = delete;
+	auto operator=(scope_exit_all&&) -> scope_exit_all& = delete;
+
+private:
+	[[no_unique_address]] functions_type _functions;
+	bool _execute_on_destruction = true;
+};
+
+template <typename... EF>
+scope_exit_all(EF...) -> scope_exit_all<EF...>;
+
+namespace _detail_X_scope {
+
+// The smallest unsigned integer type with at least `N` bits.
+template <std::size_t N>
+using guard_set_mask_t =
+	std::conditional_t<(N <= 8), std::uint_least8_t,
+	std::conditional_t<(N <= 16), std::uint_least16_t,
+	std::conditional_t<(N <= 32), std::uint_least32_t,
+	std::uint_least64_t>>>;
+
+} // namespace _detail_X_scope
+
+// guard_set<EF...>
+//
+// guard_set is a scope_exit_all where each function can be released
+// separately. The armed state is a single bitmask, with bit `I` for the
+// function with index `I`:
+//      auto guards = guard_set{
+//          [&] { free_buffer(); },
+//          [&] { close(fd); }};
+//      // [...]
+//      guards.release<0>();  // ownership of the buffer handed off
+//      // On scope exit, only close() is called.
+//
+// The destructor tests the bit of each function, from the highest to the
+// lowest (so the functions are called in reverse order, like for
+// scope_exit_all), and calls the function directly (so it can be inlined)
+// if the bit is set.
+//
+// If initializing one of the functions fails, the same happens as for
+// scope_exit_all.
+//
+// Extra requirements (in addition to scope_exit requirements, for each
+// `EF`):
+//      *   0 < sizeof...(EF) <= 64
+template <typename... EF>
+class guard_set
+{
+	using functions_type = _detail_X_scope::exit_function_pack<true, std::index_sequence_for<EF...>, EF...>;
+
+public:
+	static_assert(sizeof...(EF) > 0);
+	static_assert(sizeof...(EF) <= 64);
+	static_assert((((std::is_object_v<EF> and std::is_destructible_v<EF>) or std::is_lvalue_reference_v<EF>) and ...));
+	static_assert((std::is_invocable_v<std::remove_reference_t<EF>> and ...));
+
+	using mask_type = _detail_X_scope::guard_set_mask_t<sizeof...(EF)>;
+
+	// The mask with the bits of all the functions set.
+	static constexpr auto all = static_cast<mask_type>(
+		mask_type(-1) >> (std::numeric_limits<mask_type>::digits - sizeof...(EF)));
+
+	// The mask with only the bit of the function with index `I` set.
+	template <std::size_t I>
+		requires (I < sizeof...(EF))
+	static constexpr auto bit = static_cast<mask_type>(mask_type{1} << I);
+
+	template <typename... EFP>
+		requires _detail_X_scope::is_exit_function_pack_init_v<guard_set, sizeof...(EF), EFP...>
+	explicit guard_set(EFP&&... fs)
+		noexcept(std::is_nothrow_constructible_v<functions_type, EFP...>)
+	:
+		_functions(std::forward<EFP>(fs)...)
+	{}
+
+	guard_set(guard_set&& other)
+		noexcept(std::is_nothrow_move_constructible_v<functions_type>)
+	:
+		_functions(std::move(other._functions)),
+		_armed{other._armed}
+	{
+		other.release();
+	}
+
+	~guard_set()
+	{
+		[this]<std::size_t... J>(std::index_sequence<J...>)
+		{
+			constexpr auto n = sizeof...(EF);
+
+			(((_armed & bit<n - 1 - J>) ? (void)_detail_X_scope::get_exit_function<n - 1 - J>(_functions)() : void()), ...);
+		}(std::index_sequence_for<EF...>{});
+	}
+
+	// Releases the function with index `I`.
+	template <std::size_t I>
+		requires (I < sizeof...(EF))
+	auto release() noexcept -> void
+	{
+		_armed = static_cast<mask_type>(_armed & ~bit<I>);
+	}
+
+	// Releases the functions whose bits are set in `mask`.
+	auto release(mask_type mask) noexcept -> void
+	{
+		_armed = static_cast<mask_type>(_armed & ~mask);
+	}
+
+	// Releases all the functions.
+	auto release() noexcept -> void
+	{
+		_armed = 0;
+	}
+
+	// Returns the mask of the functions that are still armed.
+	auto armed() const noexcept -> mask_type
+	{
+		return _armed;
+	}
+
+	guard_set(guard_set const&) = delete;
+	auto operator=(guard_set const&) -> guard_set& = delete;
+	auto operator=(guard_set&&) -> guard_set& = delete;
+
+private:
+	[[no_unique_address]] functions_type _functions;
+	mask_type _armed = all;
+};
+
+template <typename... EF>
+guard_set(EF...) -> guard_set<EF...>;
+
+namespace _detail_X_scope {
+
+// any_exit_function_ops
+//
+// The operations on the type-erased exit function of an any_scope_exit,
+// one static instance per function type.
+struct any_exit_function_ops
+{
+	// Calls the function.
+	void (*call)(void*);
+
+	// Move-constructs (or if that might throw, copy-constructs) the function
+	// into the (uninitialized) second storage, and destroys the original.
+	void (*relocate)(void*, void*) noexcept;
+
+	// Destroys the function.
+	void (*destroy)(void*) noexcept;
+};
+
+template <typename F>
+inline constexpr auto any_exit_function_ops_for = any_exit_function_ops{
+	[](void* p)
+	{
+		(*std::launder(static_cast<F*>(p)))();
+	},
+	[](void* from, void* to) noexcept
+	{
+		auto& f = *std::launder(static_cast<F*>(from));
+		::new (to) F(move_init_if_noexcept<F, F&&>(f));
+		f.~F();
+	},
+	[](void* p) noexcept
+	{
+		std::launder(static_cast<F*>(p))->~F();
+	},
+};
+
+// is_any_exit_function_init_v<EFP, Guard, Capacity, Alignment>
+//
+// Whether an any_scope_exit (`Guard`) can be constructed from an `EFP`: if
+// it's not the guard itself, and the (decayed) function fits in the
+// storage.
+template <typename EFP, typename Guard, std::size_t Capacity, std::size_t Alignment>
+inline constexpr auto is_any_exit_function_init_v =
+	not std::is_same_v<std::remove_cvref_t<EFP>, Guard>
+	and sizeof(std::decay_t<EFP>) <= Capacity
+	and alignof(std::decay_t<EFP>) <= Alignment;
+
+} // namespace _detail_X_scope
+
+// any_scope_exit<Capacity, Alignment>
+//
+// any_scope_exit is a scope_exit whose exit function type is erased, so
+// guards with different function types have the same type, and can be
+// stored in data members and containers, or passed across library
+// boundaries (without std::function).
+//
+// The function is always stored inline, in `Capacity` bytes aligned to
+// `Alignment` (by default, enough for a lambda capturing 3 pointers or
+// references); there is no heap allocation. A function that doesn't fit
+// can't be used (the constructor doesn't participate in overload
+// resolution), rather than being allocated elsewhere.
+//
+// Like scope_exit, it calls its function when destroyed, unless it was
+// released or moved from. Unlike scope_exit, it is also move-assignable
+// (so it can be used in a std::vector), which calls the function of the
+// assigned-to guard first, as if it were destroyed. Calling the function
+// through any_scope_exit can't be noexcept-aware, so the destructor and
+// move-assignment are always noexcept: if the function throws, the program
+// terminates.
+//
+// The function is stored by value (copied from lvalues, like scope_exit's
+// deduction guide); to store a reference, use `std::ref()`.
+//
+// Usage:
+//      auto guards = std::vector<any_scope_exit<>>{};
+//      guards.emplace_back([&] { close(fd); });
+//      guards.emplace_back([p] { free(p); });
+//
+// Extra requirements (in addition to basic scope guard requirements):
+//      *   std::is_nothrow_move_constructible_v<F>
+//              or std::is_nothrow_copy_constructible_v<F>
+//          (where `F` is the decayed function type)
+template <std::size_t Capacity = 3 * sizeof(void*), std::size_t Alignment = alignof(void*)>
+class any_scope_exit
+{
+public:
+	template <typename EFP>
+		requires (_detail_X_scope::is_any_exit_function_init_v<EFP, any_scope_exit, Capacity, Alignment>
+			and not _detail_X_scope::needs_init_failure_handler_v<std::decay_t<EFP>, EFP>)
+	explicit any_scope_exit(EFP&& f)
+		noexcept(_detail_X_scope::is_nothrow_exit_function_init_v<std::decay_t<EFP>, EFP>)
+	{
+		_init<std::decay_t<EFP>, EFP>(f);
+	}
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+	template <typename EFP>
+		requires (_detail_X_scope::is_any_exit_function_init_v<EFP, any_scope_exit, Capacity, Alignment>
+			and _detail_X_scope::needs_init_failure_handler_v<std::decay_t<EFP>, EFP>)
+	explicit any_scope_exit(EFP&& f)
+	{
+		try
+		{
+			_init<std::decay_t<EFP>, EFP>(f);
+		}
+		catch (...)
+		{
+			f();
+			throw;
+		}
+	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+
+	any_scope_exit(any_scope_exit&& other) noexcept
+	{
+		_take(other);
+	}
+
+	auto operator=(any_scope_exit&& other) noexcept -> any_scope_exit&
+	{
+		if (this != &other)
+		{
+			_exit();
+			_take(other);
+		}
+
+		return *this;
+	}
+
+	~any_scope_exit()
+	{
+		_exit();
+	}
+
+	auto release() noexcept -> void
+	{
+		if (_p_ops != nullptr)
+			std::exchange(_p_ops, nullptr)->destroy(_storage);
+	}
+
+	// Not copyable.
+	any_scope_exit(any_scope_exit const&) = delete;
+	auto operator=(any_scope_exit const&) -> any_scope_exit& = delete;
+
+private:
+	template <typename F, typename EFP>
+	auto _init(EFP& f) -> void
+	{
+		static_assert(std::is_object_v<F> and std::is_destructible_v<F>);
+		static_assert(std::is_invocable_v<F&>);
+		static_assert(std::is_nothrow_move_constructible_v<F> or std::is_nothrow_copy_constructible_v<F>,
+			"any_scope_exit needs a function that can be moved or copied without throwing");
+
+		::new (static_cast<void*>(_storage)) F(_detail_X_scope::move_init_if_noexcept<F, EFP>(f));
+		_p_ops = &_detail_X_scope::any_exit_function_ops_for<F>;
+	}
+
+	auto _take(any_scope_exit& other) noexcept -> void
+	{
+		if (other._p_ops != nullptr)
+		{
+			other._p_ops->relocate(other._storage, _storage);
+			_p_ops = std::exchange(other._p_ops, nullptr);
+		}
+	}
+
+	auto _exit() noexcept -> void
+	{
+		if (_p_ops != nullptr)
+		{
+			_p_ops->call(_storage);
+			release();
+		}
+	}
+
+	alignas(Alignment) std::byte _storage[Capacity];
+	_detail_X_scope::any_exit_function_ops const* _p_ops = nullptr;
+};
+
+namespace _detail_X_scope {
+
+// exit_function_ref
+//
+// A non-owning, type-erased reference to an exit function (a function
+// object or a function): a pointer to it, and a pointer to a "thunk" that
+// calls it. A null thunk means there is no function (which the `_ref`
+// scope guards use to mean "disarmed").
+class exit_function_ref
+{
+public:
+	// (An exit_function_ref is itself invocable, but is copied, not
+	// referred to.)
+	template <typename F>
+		requires (std::is_object_v<F> and std::is_invocable_v<F&>
+			and not std::is_same_v<std::remove_cv_t<F>, exit_function_ref>)
+	explicit exit_function_ref(F& f) noexcept :
+		_target{.p_object = const_cast<void*>(static_cast<void const volatile*>(std::addressof(f)))},
+		_thunk{[](target t) { (*static_cast<F*>(t.p_object))(); }}
+	{}
+
+	template <typename F>
+		requires (std::is_function_v<F> and std::is_invocable_v<F&>)
+	explicit exit_function_ref(F& f) noexcept :
+		_target{.p_function = reinterpret_cast<void (*)()>(std::addressof(f))},
+		_thunk{[](target t) { reinterpret_cast<F*>(t.p_function)(); }}
+	{}
+
+	explicit operator bool() const noexcept { return _thunk != nullptr; }
+
+	auto reset() noexcept -> void { _thunk = nullptr; }
+
+	auto operator()() const -> void { _thunk(_target); }
+
+private:
+	// Functions can't be pointed to with a `void*`.
+	union target
+	{
+		void* p_object;
+		void (*p_function)();
+	};
+
+	target _target;
+	void (*_thunk)(target);
+};
+
+} // namespace _detail_X_scope
+
+// scope_exit_ref
+//
+// scope_exit_ref is a scope_exit that refers to an exit function that lives
+// elsewhere (usually a lambda in the enclosing scope), rather than storing
+// it, and whose type doesn't depend on the function's type: it stores only
+// a pointer to the function and a pointer to a function that calls it.
+//
+// It is like `scope_exit<EF&>`, except that there is only one scope_exit_ref
+// type, so there is only one destructor, no matter how many different
+// functions it is used with, which can reduce code size when there are many
+// different cleanup lambdas.
+//
+// The referred-to function must outlive the guard. Only lvalues can be
+// referred to:
+//      auto cleanup = [&] { close(fd); };
+//      auto const _ = scope_exit_ref{cleanup};
+class scope_exit_ref
+{
+public:
+	template <typename F>
+		requires (not std::is_same_v<std::remove_cv_t<F>, scope_exit_ref>)
+	explicit scope_exit_ref(F& f) noexcept :
+		_exit_function{f}
+	{}
+
+	// The function would not outlive the guard. (Constrained to rvalues, so
+	// that copying a guard uses the deleted copy constructor instead.)
+	template <typename F>
+		requires (not std::is_lvalue_reference_v<F>)
+	scope_exit_ref(F&&) = delete;
+
+	scope_exit_ref(scope_exit_ref&& other) noexcept :
+		_exit_function{other._exit_function}
+	{
+		other.release();
+	}
+
+	~scope_exit_ref()
+	{
+		if (_exit_function)
+			_exit_function();
+	}
+
+	auto release() noexcept -> void
+	{
+		_exit_function.reset();
+	}
+
+	scope_exit_ref(scope_exit_ref const&) = delete;
+	auto operator=(scope_exit_ref const&) -> scope_exit_ref& = delete;
+	auto operator=(scope_exit_ref&&) -> scope_exit_ref& = delete;
+
+private:
+	_detail_X_scope::exit_function_ref _exit_function;
+};
+
+namespace _detail_X_scope {
+
+// failure_signal<S>
+//
+// A type whose value says whether an operation failed, without an
+// exception: either an `expected`-like result (that failed if it doesn't
+// have a value), or an error-code-like type (that failed if it is `true`
+// when converted to `bool`, like `std::error_code`, or a plain `bool`
+// "failed" flag). Checking the value must not throw.
+template <typename S>
+concept failure_signal =
+	requires (S const& s)
+	{
+		{ s.has_value() } noexcept -> std::convertible_to<bool>;
+	}
+	or requires (S const& s)
+	{
+		{ static_cast<bool>(s) } noexcept;
+	};
+
+template <failure_signal S>
+constexpr auto signals_failure(S const& s) noexcept -> bool
+{
+	if constexpr (requires { s.has_value(); })
+		return not s.has_value();
+	else
+		return static_cast<bool>(s);
+}
+
+// failure_signal_ref<S>
+//
+// Refers to the failure signal a guard is bound to, or if `S` is void, is
+// the guard's own failure flag, set by `fail()`.
+template <typename S>
+class failure_signal_ref
+{
+public:
+	constexpr explicit failure_signal_ref(S const& s) noexcept :
+		_p_signal{std::addressof(s)}
+	{}
+
+	constexpr auto failed() const noexcept -> bool { return signals_failure(*_p_signal); }
+
+private:
+	S const* _p_signal = nullptr;
+};
+
+template <>
+class failure_signal_ref<void>
+{
+public:
+	constexpr auto failed() const noexcept -> bool { return _failed; }
+
+	constexpr auto fail() noexcept -> void { _failed = true; }
+
+private:
+	bool _failed = false;
+};
+
+// signal_scope_guard<EF, S, CallOnFailure>
+//
+// Implementation of scope_fail_if (CallOnFailure is true) and
+// scope_success_if (CallOnFailure is false).
+template <typename EF, typename S, bool CallOnFailure>
+class signal_scope_guard : public scope_guard_base<EF>
+{
+	// Placeholder for the status parameter when `S` is void (the
+	// constructors that take it are disabled in that case anyway).
+	struct no_signal {};
+
+	using signal_type = std::conditional_t<std::is_void_v<S>, no_signal, S>;
+
+	// As with scope_fail, if initializing the exit function fails, that
+	// counts as a failure, so scope_fail_if calls it. scope_success_if
+	// never needs the handler.
+	template <typename EFP>
+	static constexpr auto _needs_init_failure_handler =
+		CallOnFailure and needs_init_failure_handler_v<EF, EFP>;
+
+public:
+	template <typename EFP>
+		requires (not std::is_void_v<S> and not _needs_init_failure_handler<EFP>)
+	signal_scope_guard(signal_type const& signal, EFP&& f)
+		noexcept(is_nothrow_exit_function_init_v<EF, EFP>)
+	:
+		_exit_function{move_init_if_noexcept<EF, EFP>(f)},
+		_signal{signal}
+	{
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+	template <typename EFP>
+		requires (not std::is_void_v<S> and _needs_init_failure_handler<EFP>)
+	signal_scope_guard(signal_type const& signal, EFP&& f)
+	try :
+		_exit_function{move_init_if_noexcept<EF, EFP>(f)},
+		_signal{signal}
+	{
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+	catch (...)
+	{
+		f();
+	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+
+	// The signal is checked on destruction, so it must not be a temporary.
+	template <typename EFP>
+		requires (not std::is_void_v<S>)
+	signal_scope_guard(signal_type const&&, EFP&&) = delete;
+
+	template <typename EFP>
+		requires (std::is_void_v<S> and not _needs_init_failure_handler<EFP>)
+	explicit signal_scope_guard(EFP&& f)
+		noexcept(is_nothrow_exit_function_init_v<EF, EFP>)
+	:
+		_exit_function{move_init_if_noexcept<EF, EFP>(f)}
+	{
+		static_assert(not std::is_base_of_v<signal_scope_guard, std::remove_cvref_t<EFP>>);
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+	template <typename EFP>
+		requires (std::is_void_v<S> and _needs_init_failure_handler<EFP>)
+	explicit signal_scope_guard(EFP&& f)
+	try :
+		_exit_function{move_init_if_noexcept<EF, EFP>(f)}
+	{
+		static_assert(not std::is_base_of_v<signal_scope_guard, std::remove_cvref_t<EFP>>);
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+	catch (...)
+	{
+		f();
+	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+
+	signal_scope_guard(signal_scope_guard&& other)
+		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
+	:
+		_exit_function{std::move(other._exit_function)},
+		_signal{other._signal}
+	{
+		other.release();
+	}
+
+	~signal_scope_guard()
+		noexcept(noexcept(_exit_function()))
+	{
+		if (_exit_function.is_armed() and _signal.failed() == CallOnFailure)
+			_exit_function();
+	}
+
+	auto release() noexcept -> void
+	{
+		_exit_function.disarm();
+	}
+
+	auto fail() noexcept -> void
+		requires std::is_void_v<S>
+	{
+		_signal.fail();
+	}
+
+private:
+	exit_function_storage<EF> _exit_function;
+	failure_signal_ref<S> _signal;
+};
+
+} // namespace _detail_X_scope
+
+// scope_fail_if<EF, S>
+//
+// scope_fail_if is a scope guard that calls its contained function only if
+// an explicit failure signal says the scope failed, rather than if the scope
+// is exited via stack unwinding. It is meant for code that reports errors
+// with error codes or `expected`-like results rather than exceptions, and
+// never queries the number of uncaught exceptions.
+//
+// It can be bound to a status object, which is checked when the guard is
+// destroyed (so it must outlive the guard):
+//      auto ec = std::error_code{};
+//      auto const _ = scope_fail_if{ec, [&] { rollback(); }};
+//
+//      ec = step_1();
+//      if (ec)
+//          return ec;      // rollback() is called.
+//
+// The status object can be anything that satisfies failure_signal: an
+// `expected`-like result (failure if it has no value), or anything that
+// converts to `bool` (failure if it is `true`), like `std::error_code`.
+//
+// Or it can be constructed with only the function, and then signalled by
+// calling `fail()`:
+//      auto guard = scope_fail_if{[&] { rollback(); }};
+//
+//      if (not step_1())
+//      {
+//          guard.fail();
+//          return false;   // rollback() is called.
+//      }
+//
+// Otherwise, it works like scope_fail: it can be released or moved, and if
+// initializing the exit function throws, the function is called.
+//
+// Extra requirements (in addition to basic scope guard requirements):
+//      *   `S` is void, or satisfies failure_signal.
+template <typename EF, typename S = void>
+	requires (std::is_void_v<S> or _detail_X_scope::failure_signal<S>)
+class scope_fail_if : public _detail_X_scope::signal_scope_guard<EF, S, true>
+{
+public:
+	using _detail_X_scope::signal_scope_guard<EF, S, true>::signal_scope_guard;
+};
+
+template <typename EF>
+scope_fail_if(EF) -> scope_fail_if<EF>;
+
+template <typename S, typename EF>
+scope_fail_if(S&, EF) -> scope_fail_if<EF, std::remove_const_t<S>>;
+
+// scope_success_if<EF, S>
+//
+// scope_success_if is the counterpart of scope_fail_if: it calls its
+// contained function only if the failure signal says the scope did NOT fail
+// (or, if it has no status object, if `fail()` was not called):
+//      auto ec = std::error_code{};
+//      auto const _ = scope_success_if{ec, [&] { commit(); }};
+//
+// Otherwise, it works like scope_success: it can be released or moved, and
+// if initializing the exit function throws, the function is not called.
+template <typename EF, typename S = void>
+	requires (std::is_void_v<S> or _detail_X_scope::failure_signal<S>)
+class scope_success_if : public _detail_X_scope::signal_scope_guard<EF, S, false>
+{
+public:
+	using _detail_X_scope::signal_scope_guard<EF, S, false>::signal_scope_guard;
+};
+
+template <typename EF>
+scope_success_if(EF) -> scope_success_if<EF>;
+
+template <typename S, typename EF>
+scope_success_if(S&, EF) -> scope_success_if<EF, std::remove_const_t<S>>;
+
+// outcome
+//
+// How a scope was exited: normally (success), or via stack unwinding
+// (failure).
+enum class outcome : bool
+{
+	success,
+	failure,
+};
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+
+// scope_checkpoint
+//
+// scope_checkpoint is a snapshot of the number of uncaught exceptions, that
+// can be shared by several scope_fail, scope_success, or scope_outcome
+// guards. Guards constructed with a checkpoint use its count, rather than
+// querying the number of uncaught exceptions themselves:
+//      auto const checkpoint = scope_checkpoint{};
+//
+//      auto const s1 = scope_fail{checkpoint, [] { undo_1(); }};
+//      auto const s2 = scope_fail{checkpoint, [] { undo_2(); }};
+//      auto const s3 = scope_fail{checkpoint, [] { undo_3(); }};
+//
+// All guards constructed with a checkpoint should be constructed in the same
+// scope as the checkpoint (or rather, in a scope that is exited if and only
+// if the checkpoint's scope is exited).
+//
+// The guards are otherwise independent (each can be moved or released on
+// its own), so each still checks the number of uncaught exceptions on
+// destruction. To check it once for all, query `unwinding()` once, or
+// use a single scope_outcome.
+class scope_checkpoint
+{
+public:
+	scope_checkpoint() noexcept :
+		_uncaught_on_creation{_detail_X_scope::uncaught_exceptions()}
+	{}
+
+	// The number of uncaught exceptions when the checkpoint was created.
+	constexpr auto uncaught_on_creation() const noexcept -> int
+	{
+		return _uncaught_on_creation;
+	}
+
+	// Whether there are more uncaught exceptions now than when the checkpoint
+	// was created (in other words, whether the scope is being exited via
+	// stack unwinding).
+	auto unwinding() const noexcept -> bool
+	{
+		return _detail_X_scope::uncaught_exceptions() > _uncaught_on_creation;
+	}
+
+private:
+	int _uncaught_on_creation = 0;
+};
+
+// scope_fail<EF>
+//
+// scope_fail is a scope guard that calls its contained function only in
+// the case that it is destroyed during stack unwinding.
+//
+// `rearm()` must not be called on a moved-from guard. The moved-from state
+// is the released state, so this is not checked: the destructor would call
+// the moved-from function (if destroyed during stack unwinding).
+template <typename EF>
+class scope_fail : public _detail_X_scope::scope_guard_base<EF>
+{
+public:
+	template <typename EFP>
+	explicit scope_fail(EFP&& f)
+		noexcept(std::is_nothrow_constructible_v<EF, EFP> or std::is_nothrow_constructible_v<EF, EFP&>)
+	:
+		scope_fail{scope_checkpoint{}, std::forward<EFP>(f)}
+	{}
+
+	// As with scope_exit, no function-try-block is needed if initializing the
+	// exit function can't throw.
+	template <typename EFP>
+		requires (not _detail_X_scope::needs_init_failure_handler_v<EF, EFP>)
+	scope_fail(scope_checkpoint const& checkpoint, EFP&& f) noexcept :
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)},
+		_uncaught_on_creation{checkpoint.uncaught_on_creation()}
+	{
+		// 7.5.2.10 requirements.
+		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_fail>);
+	}
+
+	template <typename EFP>
+	scope_fail(scope_checkpoint const& checkpoint, EFP&& f)
+	try :
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)},
+		_uncaught_on_creation{checkpoint.uncaught_on_creation()}
+	{
+		// 7.5.2.10 requirements.
+		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_fail>);
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+	catch (...)
+	{
+		f();
+	}
+
+	scope_fail(scope_fail&& other)
+		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
+	:
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EF&&>(other._exit_function)},
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	~scope_fail()
+	{
+		if (_detail_X_scope::uncaught_exceptions() > _uncaught_on_creation)
+			_exit_function();
+	}
+
+	auto release() noexcept -> void
+	{
+		// The number of uncaught exceptions can never be greater than the
+		// max value of int, so by setting the count to this, the destructor
+		// condition can never be met.
+		_uncaught_on_creation = std::numeric_limits<int>::max();
+	}
+
+	// Calls the exit function now if the destructor would (if there are
+	// more uncaught exceptions than when the guard was created), and
+	// releases the guard (before the call).
+	auto execute() noexcept(noexcept(_exit_function())) -> void
+	{
+		auto const call = _detail_X_scope::uncaught_exceptions() > _uncaught_on_creation;
+		release();
+
+		if (call)
+			_exit_function();
+	}
+
+	// Re-arms the guard as if it were created now (with the current number
+	// of uncaught exceptions). Must not be used on a moved-from guard.
+	auto rearm() noexcept -> void
+	{
+		_uncaught_on_creation = _detail_X_scope::uncaught_exceptions();
+	}
+
+private:
+	EF _exit_function;
+	int _uncaught_on_creation = 0;
+};
+
+template <typename EF>
+scope_fail(EF) -> scope_fail<EF>;
+
+template <typename EF>
+scope_fail(scope_checkpoint, EF) -> scope_fail<EF>;
+
+// scope_fail_fn<F>
+//
+// scope_fail_fn is the same as scope_fail, except that the exit function is
+// a template argument (usually a pointer to a function), rather than a data
+// member. It stores only the number of uncaught exceptions at creation.
+//
+// Usage:
+//      auto const _ = scope_fail_fn<&rollback>{};
+template <auto F>
+class scope_fail_fn : public _detail_X_scope::scope_guard_base<decltype(F)>
+{
+public:
+	scope_fail_fn() noexcept :
+		_uncaught_on_creation{_detail_X_scope::uncaught_exceptions()}
+	{}
+
+	constexpr scope_fail_fn(scope_fail_fn&& other) noexcept :
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	~scope_fail_fn()
+	{
+		if (_detail_X_scope::uncaught_exceptions() > _uncaught_on_creation)
+			F();
+	}
+
+	constexpr auto release() noexcept -> void
+	{
+		// See scope_fail::release().
+		_uncaught_on_creation = std::numeric_limits<int>::max();
+	}
+
+private:
+	int _uncaught_on_creation = 0;
+};
+
+// scope_success<EF>
+//
+// scope_success is a scope guard that calls its contained function only in
+// the case that it is destroyed under normal conditions (not stack
+// unwinding).
+//
+// `rearm()` must not be called on a moved-from guard. The moved-from state
+// is the released state, so this is not checked: the destructor would call
+// the moved-from function (if not destroyed during stack unwinding).
+template <typename EF>
+class scope_success : public _detail_X_scope::scope_guard_base<EF>
+{
+public:
+	template <typename EFP>
+	explicit scope_success(EFP&& f)
+		noexcept(std::is_nothrow_constructible_v<EF, EFP> or std::is_nothrow_constructible_v<EF, EFP&>)
+	:
+		scope_success{scope_checkpoint{}, std::forward<EFP>(f)}
+	{}
+
+	template <typename EFP>
+	scope_success(scope_checkpoint const& checkpoint, EFP&& f)
+		noexcept(std::is_nothrow_constructible_v<EF, EFP> or std::is_nothrow_constructible_v<EF, EFP&>)
+	:
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)},
+		_uncaught_on_creation{checkpoint.uncaught_on_creation()}
+	{
+		// 7.5.2.15 requirements.
+		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_success>);
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+
+	scope_success(scope_success&& other)
+		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
+	:
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EF&&>(other._exit_function)},
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	~scope_success()
+		noexcept(noexcept(_exit_function()))
+	{
+		if (_detail_X_scope::uncaught_exceptions() <= _uncaught_on_creation)
+			_exit_function();
+	}
+
+	auto release() noexcept -> void
+	{
+		// The number of uncaught exceptions can never be less than zero,
+		// so by setting the count to -1, the destructor condition can never
+		// be met.
+		_uncaught_on_creation = -1;
+	}
+
+	// Calls the exit function now if the destructor would (if there are no
+	// more uncaught exceptions than when the guard was created), and
+	// releases the guard (before the call).
+	auto execute() noexcept(noexcept(_exit_function())) -> void
+	{
+		auto const call = _detail_X_scope::uncaught_exceptions() <= _uncaught_on_creation;
+		release();
+
+		if (call)
+			_exit_function();
+	}
+
+	// Re-arms the guard as if it were created now (with the current number
+	// of uncaught exceptions). Must not be used on a moved-from guard.
+	auto rearm() noexcept -> void
+	{
+		_uncaught_on_creation = _detail_X_scope::uncaught_exceptions();
+	}
+
+private:
+	EF _exit_function;
+	int _uncaught_on_creation = 0;
+};
+
+template <typename EF>
+scope_success(EF) -> scope_success<EF>;
+
+template <typename EF>
+scope_success(scope_checkpoint, EF) -> scope_success<EF>;
+
+// scope_outcome<EF>
+//
+// scope_outcome is a scope guard that calls its contained function whenever
+// the scope exits - like scope_exit - but passes it the outcome: whether
+// the exit was a success (normal) or failure (stack unwinding) exit.
+//
+// It replaces a pair of scope_success and scope_fail guards on the same
+// operation with a single guard, that stores one function and one
+// uncaught exception count, and checks the number of uncaught exceptions
+// only once on creation and once on destruction:
+//      auto const _ = scope_outcome{[&](outcome o)
+//      {
+//          if (o == outcome::success)
+//              commit();
+//          else
+//              rollback();
+//      }};
+//
+// Extra requirements (in addition to basic scope guard requirements):
+//      *   If `g` is an instance of `remove_reference_t<EF>`, `g(o)` should
+//          be well-formed for an `outcome` value `o`, and `g(outcome::failure)`
+//          should not raise an exception.
+template <typename EF>
+class scope_outcome : public _detail_X_scope::scope_guard_base<EF, outcome>
+{
+public:
+	template <typename EFP>
+	explicit scope_outcome(EFP&& f)
+		noexcept(std::is_nothrow_constructible_v<EF, EFP> or std::is_nothrow_constructible_v<EF, EFP&>)
+	:
+		scope_outcome{scope_checkpoint{}, std::forward<EFP>(f)}
+	{}
+
+	template <typename EFP>
+		requires (not _detail_X_scope::needs_init_failure_handler_v<EF, EFP>)
+	scope_outcome(scope_checkpoint const& checkpoint, EFP&& f) noexcept :
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)},
+		_uncaught_on_creation{checkpoint.uncaught_on_creation()}
+	{
+		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_outcome>);
+	}
+
+	template <typename EFP>
+	scope_outcome(scope_checkpoint const& checkpoint, EFP&& f)
+	try :
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EFP>(f)},
+		_uncaught_on_creation{checkpoint.uncaught_on_creation()}
+	{
+		static_assert(not std::is_same_v<std::remove_cvref_t<EFP>, scope_outcome>);
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+	catch (...)
+	{
+		// Same as scope_fail: the exception is a failure of the scope.
+		f(outcome::failure);
+	}
+
+	scope_outcome(scope_outcome&& other)
+		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
+	:
+		_exit_function{_detail_X_scope::move_init_if_noexcept<EF, EF&&>(other._exit_function)},
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	// Like scope_success, the destructor may throw if the function may. (But
+	// of course, if it throws on failure, std::terminate() is called.)
+	~scope_outcome()
+		noexcept(noexcept(_exit_function(outcome::success)))
+	{
+		if (_uncaught_on_creation >= 0)
+		{
+			_exit_function(_detail_X_scope::uncaught_exceptions() > _uncaught_on_creation
+				? outcome::failure
+				: outcome::success);
+		}
+	}
+
+	auto release() noexcept -> void
+	{
+		// The number of uncaught exceptions can never be less than zero, so
+		// a negative count marks the guard as released.
+		_uncaught_on_creation = -1;
+	}
+
+private:
+	EF _exit_function;
+	int _uncaught_on_creation = 0;
+};
+
+template <typename EF>
+scope_outcome(EF) -> scope_outcome<EF>;
+
+template <typename EF>
+scope_outcome(scope_checkpoint, EF) -> scope_outcome<EF>;
+
+// scope_success_fn<F>
+//
+// scope_success_fn is the same as scope_success, except that the exit
+// function is a template argument (usually a pointer to a function), rather
+// than a data member. It stores only the number of uncaught exceptions at
+// creation.
+//
+// Usage:
+//      auto const _ = scope_success_fn<&commit>{};
+template <auto F>
+class scope_success_fn : public _detail_X_scope::scope_guard_base<decltype(F)>
+{
+public:
+	scope_success_fn() noexcept :
+		_uncaught_on_creation{_detail_X_scope::uncaught_exceptions()}
+	{}
+
+	constexpr scope_success_fn(scope_success_fn&& other) noexcept :
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	~scope_success_fn()
+		noexcept(noexcept(F()))
+	{
+		if (_detail_X_scope::uncaught_exceptions() <= _uncaught_on_creation)
+			F();
+	}
+
+	constexpr auto release() noexcept -> void
+	{
+		// See scope_success::release().
+		_uncaught_on_creation = -1;
+	}
+
+private:
+	int _uncaught_on_creation = 0;
+};
+
+// scope_fail_ref, scope_success_ref
+//
+// The scope_fail and scope_success equivalents of scope_exit_ref: they refer
+// to an exit function that must outlive them, and have a single type for
+// any function.
+//
+// Usage:
+//      auto rollback = [&] { undo(); };
+//      auto const _ = scope_fail_ref{rollback};
+//
+// Unlike scope_success, scope_success_fn, and scope_success_all, whose
+// destructors are `noexcept` if the function is, the destructor of
+// scope_success_ref is always `noexcept(false)`. Whether the function can
+// throw is part of its type, which is erased, and a `noexcept` specification
+// can only depend on the guard's type. So code that destroys a
+// scope_success_ref must always allow for an exception, even if the
+// function can't throw. Where that matters, use `scope_success<F&>`, which
+// also refers to the function rather than storing it.
+class scope_fail_ref
+{
+public:
+	template <typename F>
+		requires (not std::is_same_v<std::remove_cv_t<F>, scope_fail_ref>)
+	explicit scope_fail_ref(F& f) noexcept :
+		scope_fail_ref{scope_checkpoint{}, f}
+	{}
+
+	template <typename F>
+	scope_fail_ref(scope_checkpoint const& checkpoint, F& f) noexcept :
+		_exit_function{f},
+		_uncaught_on_creation{checkpoint.uncaught_on_creation()}
+	{}
+
+	// The function would not outlive the guard. (Constrained to rvalues, so
+	// that copying a guard uses the deleted copy constructor instead.)
+	template <typename F>
+		requires (not std::is_lvalue_reference_v<F>)
+	scope_fail_ref(F&&) = delete;
+	template <typename F>
+		requires (not std::is_lvalue_reference_v<F>)
+	scope_fail_ref(scope_checkpoint const&, F&&) = delete;
+
+	scope_fail_ref(scope_fail_ref&& other) noexcept :
+		_exit_function{other._exit_function},
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	~scope_fail_ref()
+	{
+		if (_exit_function and _detail_X_scope::uncaught_exceptions() > _uncaught_on_creation)
+			_exit_function();
+	}
+
+	auto release() noexcept -> void
+	{
+		_exit_function.reset();
+	}
+
+	scope_fail_ref(scope_fail_ref const&) = delete;
+	auto operator=(scope_fail_ref const&) -> scope_fail_ref& = delete;
+	auto operator=(scope_fail_ref&&) -> scope_fail_ref& = delete;
+
+private:
+	_detail_X_scope::exit_function_ref _exit_function;
+	int _uncaught_on_creation = 0;
+};
+
+class scope_success_ref
+{
+public:
+	template <typename F>
+		requires (not std::is_same_v<std::remove_cv_t<F>, scope_success_ref>)
+	explicit scope_success_ref(F& f) noexcept :
+		scope_success_ref{scope_checkpoint{}, f}
+	{}
+
+	template <typename F>
+	scope_success_ref(scope_checkpoint const& checkpoint, F& f) noexcept :
+		_exit_function{f},
+		_uncaught_on_creation{checkpoint.uncaught_on_creation()}
+	{}
+
+	// The function would not outlive the guard. (Constrained to rvalues, so
+	// that copying a guard uses the deleted copy constructor instead.)
+	template <typename F>
+		requires (not std::is_lvalue_reference_v<F>)
+	scope_success_ref(F&&) = delete;
+	template <typename F>
+		requires (not std::is_lvalue_reference_v<F>)
+	scope_success_ref(scope_checkpoint const&, F&&) = delete;
+
+	scope_success_ref(scope_success_ref&& other) noexcept :
+		_exit_function{other._exit_function},
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	// As with scope_success, the function may throw. Its type is not known,
+	// so always assume it might (see above).
+	~scope_success_ref() noexcept(false)
+	{
+		if (_exit_function and _detail_X_scope::uncaught_exceptions() <= _uncaught_on_creation)
+			_exit_function();
+	}
+
+	auto release() noexcept -> void
+	{
+		_exit_function.reset();
+	}
+
+	scope_success_ref(scope_success_ref const&) = delete;
+	auto operator=(scope_success_ref const&) -> scope_success_ref& = delete;
+	auto operator=(scope_success_ref&&) -> scope_success_ref& = delete;
+
+private:
+	_detail_X_scope::exit_function_ref _exit_function;
+	int _uncaught_on_creation = 0;
+};
+
+// scope_fail_assignable<EF>
+// scope_success_assignable<EF>
+//
+// scope_fail and scope_success that are also move-assignable and
+// swappable, like scope_exit_assignable.
+//
+// Move-assigning ends the assigned-to guard as if it went out of scope (so
+// its function is called only if it would have been then: for
+// scope_fail_assignable, if there are more uncaught exceptions than when it
+// was created), then takes over the other guard's function and uncaught
+// exception count. Like scope_exit_assignable, they are `final`, and must
+// not be [[no_unique_address]] members.
+//
+// Extra requirements (in addition to scope_fail/scope_success
+// requirements):
+//      *   std::is_nothrow_move_constructible_v<EF>
+//              or std::is_nothrow_copy_constructible_v<EF>
+template <typename EF>
+class scope_fail_assignable final : public scope_fail<EF>
+{
+	static_assert(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>,
+		"assignable scope guards need a function that is nothrow move or copy constructible");
+
+public:
+	using scope_fail<EF>::scope_fail;
+
+	scope_fail_assignable(scope_fail_assignable&&) noexcept = default;
+
+	auto operator=(scope_fail_assignable&& other) noexcept -> scope_fail_assignable&
+	{
+		_detail_X_scope::move_assign_scope_guard(*this, other);
+		return *this;
+	}
+
+	auto swap(scope_fail_assignable& other) noexcept -> void
+	{
+		_detail_X_scope::swap_scope_guards(*this, other);
+	}
+
+	friend auto swap(scope_fail_assignable& a, scope_fail_assignable& b) noexcept -> void
+	{
+		a.swap(b);
+	}
+};
+
+template <typename EF>
+scope_fail_assignable(EF) -> scope_fail_assignable<EF>;
+
+template <typename EF>
+scope_fail_assignable(scope_checkpoint, EF) -> scope_fail_assignable<EF>;
+
+template <typename EF>
+struct is_trivially_relocatable<scope_fail_assignable<EF>>
+	: std::bool_constant<_detail_X_scope::is_trivially_relocatable_exit_function_v<EF>> {};
+
+template <typename EF>
+class scope_success_assignable final : public scope_success<EF>
+{
+	static_assert(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>,
+		"assignable scope guards need a function that is nothrow move or copy constructible");
+
+public:
+	using scope_success<EF>::scope_success;
+
+	scope_success_assignable(scope_success_assignable&&) noexcept = default;
+
+	// If the assigned-to guard's function throws, the exception propagates,
+	// but the assignment is still done.
+	auto operator=(scope_success_assignable&& other)
+		noexcept(std::is_nothrow_destructible_v<scope_success<EF>>) -> scope_success_assignable&
+	{
+		_detail_X_scope::move_assign_scope_guard(*this, other);
+		return *this;
+	}
+
+	auto swap(scope_success_assignable& other) noexcept -> void
+	{
+		_detail_X_scope::swap_scope_guards(*this, other);
+	}
+
+	friend auto swap(scope_success_assignable& a, scope_success_assignable& b) noexcept -> void
+	{
+		a.swap(b);
+	}
+};
+
+template <typename EF>
+scope_success_assignable(EF) -> scope_success_assignable<EF>;
+
+template <typename EF>
+scope_success_assignable(scope_checkpoint, EF) -> scope_success_assignable<EF>;
+
+template <typename EF>
+struct is_trivially_relocatable<scope_success_assignable<EF>>
+	: std::bool_constant<_detail_X_scope::is_trivially_relocatable_exit_function_v<EF>> {};
+
+// scope_fail_all<EF...>
+// scope_success_all<EF...>
+//
+// scope_fail and scope_success for several exit functions, like
+// scope_exit_all: the functions are called in reverse order, if the guard
+// is destroyed during stack unwinding (scope_fail_all) or not
+// (scope_success_all). They share a single uncaught exception count, so
+// the number of uncaught exceptions is checked only once on creation and
+// once on destruction.
+//
+// If initializing one of the functions of a scope_fail_all fails, the
+// function argument, and then the functions that were already initialized
+// (in reverse order), are called. For scope_success_all, none are.
+//
+// If one of the functions of a scope_success_all throws, the ones before
+// it are not called (as for a sequence of scope_success guards, which would
+// then be destroyed during stack unwinding).
+template <typename... EF>
+class scope_fail_all
+{
+	using functions_type = _detail_X_scope::exit_function_pack<true, std::index_sequence_for<EF...>, EF...>;
+
+public:
+	static_assert(sizeof...(EF) > 0);
+	static_assert((((std::is_object_v<EF> and std::is_destructible_v<EF>) or std::is_lvalue_reference_v<EF>) and ...));
+	static_assert((std::is_invocable_v<std::remove_reference_t<EF>> and ...));
+
+	template <typename... EFP>
+		requires _detail_X_scope::is_exit_function_pack_init_v<scope_fail_all, sizeof...(EF), EFP...>
+	explicit scope_fail_all(EFP&&... fs)
+		noexcept(std::is_nothrow_constructible_v<functions_type, EFP...>)
+	:
+		scope_fail_all{scope_checkpoint{}, std::forward<EFP>(fs)...}
+	{}
+
+	template <typename... EFP>
+		requires (sizeof...(EFP) == sizeof...(EF))
+	scope_fail_all(scope_checkpoint const& checkpoint, EFP&&... fs)
+		noexcept(std::is_nothrow_constructible_v<functions_type, EFP...>)
+	:
+		_functions(std::forward<EFP>(fs)...),
+		_uncaught_on_creation{checkpoint.uncaught_on_creation()}
+	{}
+
+	scope_fail_all(scope_fail_all&& other)
+		noexcept(std::is_nothrow_move_constructible_v<functions_type>)
+	:
+		_functions(std::move(other._functions)),
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	~scope_fail_all()
+	{
+		if (_detail_X_scope::uncaught_exceptions() > _uncaught_on_creation)
+			_functions();
+	}
+
+	auto release() noexcept -> void
+	{
+		// See scope_fail::release().
+		_uncaught_on_creation = std::numeric_limits<int>::max();
+	}
+
+	// See scope_fail::execute().
+	auto execute() noexcept(functions_type::nothrow_invocable) -> void
+	{
+		auto const call = _detail_X_scope::uncaught_exceptions() > _uncaught_on_creation;
+		release();
+
+		if (call)
+			_functions();
+	}
+
+	// See scope_fail::rearm().
+	auto rearm() noexcept -> void
+	{
+		_uncaught_on_creation = _detail_X_scope::uncaught_exceptions();
+	}
+
+	scope_fail_all(scope_fail_all const&) = delete;
+	auto operator=(scope_fail_all const&) -> scope_fail_all& = delete;
+	auto operator=(scope_fail_all&&) -> scope_fail_all& = delete;
+
+private:
+	[[no_unique_address]] functions_type _functions;
+	int _uncaught_on_creation = 0;
+};
+
+template <typename... EF>
+scope_fail_all(EF...) -> scope_fail_all<EF...>;
+
+template <typename... EF>
+scope_fail_all(scope_checkpoint, EF...) -> scope_fail_all<EF...>;
+
+template <typename... EF>
+class scope_success_all
+{
+	using functions_type = _detail_X_scope::exit_function_pack<false, std::index_sequence_for<EF...>, EF...>;
+
+public:
+	static_assert(sizeof...(EF) > 0);
+	static_assert((((std::is_object_v<EF> and std::is_destructible_v<EF>) or std::is_lvalue_reference_v<EF>) and ...));
+	static_assert((std::is_invocable_v<std::remove_reference_t<EF>> and ...));
+
+	template <typename... EFP>
+		requires _detail_X_scope::is_exit_function_pack_init_v<scope_success_all, sizeof...(EF), EFP...>
+	explicit scope_success_all(EFP&&... fs)
+		noexcept(std::is_nothrow_constructible_v<functions_type, EFP...>)
+	:
+		scope_success_all{scope_checkpoint{}, std::forward<EFP>(fs)...}
+	{}
+
+	template <typename... EFP>
+		requires (sizeof...(EFP) == sizeof...(EF))
+	scope_success_all(scope_checkpoint const& checkpoint, EFP&&... fs)
+		noexcept(std::is_nothrow_constructible_v<functions_type, EFP...>)
+	:
+		_functions(std::forward<EFP>(fs)...),
+		_uncaught_on_creation{checkpoint.uncaught_on_creation()}
+	{}
+
+	scope_success_all(scope_success_all&& other)
+		noexcept(std::is_nothrow_move_constructible_v<functions_type>)
+	:
+		_functions(std::move(other._functions)),
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	~scope_success_all()
+		noexcept(functions_type::nothrow_invocable)
+	{
+		if (_detail_X_scope::uncaught_exceptions() <= _uncaught_on_creation)
+			_functions();
+	}
+
+	auto release() noexcept -> void
+	{
+		// See scope_success::release().
+		_uncaught_on_creation = -1;
+	}
+
+	// See scope_success::execute().
+	auto execute() noexcept(functions_type::nothrow_invocable) -> void
+	{
+		auto const call = _detail_X_scope::uncaught_exceptions() <= _uncaught_on_creation;
+		release();
+
+		if (call)
+			_functions();
+	}
+
+	// See scope_success::rearm().
+	auto rearm() noexcept -> void
+	{
+		_uncaught_on_creation = _detail_X_scope::uncaught_exceptions();
+	}
+
+	scope_success_all(scope_success_all const&) = delete;
+	auto operator=(scope_success_all const&) -> scope_success_all& = delete;
+	auto operator=(scope_success_all&&) -> scope_success_all& = delete;
+
+private:
+	[[no_unique_address]] functions_type _functions;
+	int _uncaught_on_creation = 0;
+};
+
+template <typename... EF>
+scope_success_all(EF...) -> scope_success_all<EF...>;
+
+template <typename... EF>
+scope_success_all(scope_checkpoint, EF...) -> scope_success_all<EF...>;
+
+#else // INDI_X_SCOPE_NO_EXCEPTIONS
+
+// Without exceptions, there is no stack unwinding, so scope_fail,
+// scope_success, and scope_outcome (and their variants) can't tell how the
+// scope was exited. They are only declared, so that using them fails with a
+// clear message (rather than as an unknown name).
+namespace _detail_X_scope {
+
+template <typename...>
+inline constexpr auto exceptions_enabled = false;
+
+} // namespace _detail_X_scope
+
+class scope_checkpoint
+{
+public:
+	template <typename T = void>
+	scope_checkpoint() noexcept
+	{
+		static_assert(_detail_X_scope::exceptions_enabled<T>,
+			"scope_checkpoint is not available when exceptions are disabled");
+	}
+};
+
+template <typename EF>
+class scope_fail
+{
+	static_assert(_detail_X_scope::exceptions_enabled<EF>,
+		"scope_fail is not available when exceptions are disabled "
+		"(use a scope_fail_if with an explicit failure signal instead)");
+
+public:
+	template <typename... Args>
+	explicit scope_fail(Args&&...) noexcept {}
+};
+
+template <typename EF>
+scope_fail(EF) -> scope_fail<EF>;
+
+template <auto F>
+class scope_fail_fn
+{
+	static_assert(_detail_X_scope::exceptions_enabled<decltype(F)>,
+		"scope_fail_fn is not available when exceptions are disabled "
+		"(use a scope_exit_fn, and release it on success)");
+};
+
+template <typename EF>
+class scope_success
+{
+	static_assert(_detail_X_scope::exceptions_enabled<EF>,
+		"scope_success is not available when exceptions are disabled "
+		"(use a scope_success_if with an explicit failure signal instead)");
+
+public:
+	template <typename... Args>
+	explicit scope_success(Args&&...) noexcept {}
+};
+
+template <typename EF>
+scope_success(EF) -> scope_success<EF>;
+
+template <auto F>
+class scope_success_fn
+{
+	static_assert(_detail_X_scope::exceptions_enabled<decltype(F)>,
+		"scope_success_fn is not available when exceptions are disabled "
+		"(use a scope_exit_fn, and release it on failure)");
+};
+
+class scope_fail_ref
+{
+public:
+	template <typename... Args>
+	explicit scope_fail_ref(Args&&...) noexcept
+	{
+		static_assert(_detail_X_scope::exceptions_enabled<Args...>,
+			"scope_fail_ref is not available when exceptions are disabled "
+			"(use a scope_fail_if with an explicit failure signal instead)");
+	}
+};
+
+class scope_success_ref
+{
+public:
+	template <typename... Args>
+	explicit scope_success_ref(Args&&...) noexcept
+	{
+		static_assert(_detail_X_scope::exceptions_enabled<Args...>,
+			"scope_success_ref is not available when exceptions are disabled "
+			"(use a scope_success_if with an explicit failure signal instead)");
+	}
+};
+
+template <typename EF>
+class scope_fail_assignable final
+{
+	static_assert(_detail_X_scope::exceptions_enabled<EF>,
+		"scope_fail_assignable is not available when exceptions are disabled "
+		"(use a scope_exit_assignable, and release it on success)");
+
+public:
+	template <typename... Args>
+	explicit scope_fail_assignable(Args&&...) noexcept {}
+};
+
+template <typename EF>
+scope_fail_assignable(EF) -> scope_fail_assignable<EF>;
+
+template <typename EF>
+class scope_success_assignable final
+{
+	static_assert(_detail_X_scope::exceptions_enabled<EF>,
+		"scope_success_assignable is not available when exceptions are disabled "
+		"(use a scope_exit_assignable, and release it on failure)");
+
+public:
+	template <typename... Args>
+	explicit scope_success_assignable(Args&&...) noexcept {}
+};
+
+template <typename EF>
+scope_success_assignable(EF) -> scope_success_assignable<EF>;
+
+template <typename... EF>
+class scope_fail_all
+{
+	static_assert(_detail_X_scope::exceptions_enabled<EF...>,
+		"scope_fail_all is not available when exceptions are disabled "
+		"(use a scope_exit_all, and release it on success)");
+
+public:
+	template <typename... Args>
+	explicit scope_fail_all(Args&&...) noexcept {}
+};
+
+template <typename... EF>
+scope_fail_all(EF...) -> scope_fail_all<EF...>;
+
+template <typename... EF>
+class scope_success_all
+{
+	static_assert(_detail_X_scope::exceptions_enabled<EF...>,
+		"scope_success_all is not available when exceptions are disabled "
+		"(use a scope_exit_all, and release it on failure)");
+
+public:
+	template <typename... Args>
+	explicit scope_success_all(Args&&...) noexcept {}
+};
+
+template <typename... EF>
+scope_success_all(EF...) -> scope_success_all<EF...>;
+
+template <typename EF>
+class scope_outcome
+{
+	static_assert(_detail_X_scope::exceptions_enabled<EF>,
+		"scope_outcome is not available when exceptions are disabled");
+
+public:
+	template <typename... Args>
+	explicit scope_outcome(Args&&...) noexcept {}
+};
+
+template <typename EF>
+scope_outcome(EF) -> scope_outcome<EF>;
+
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+
+/*****************************************************************************
+ * Unique resource
+ *
+ * unique_resource is a generalization of std::unique_ptr for any kind of
+ * resource handle - like file descriptors, sockets, or mapped memory - that
+ * is paired with a deleter function that is called with the handle to
+ * release it.
+ *
+ * Unlike the scope guards, unique_resource is move assignable, and can be
+ * default constructed (if the deleter type can be, and the resource type can
+ * be or has an invalid value; see below).
+ *
+ * Usage:
+ *      auto f(char const* path)
+ *      {
+ *          auto const file = make_unique_resource_checked(
+ *              ::open(path, O_RDONLY), -1, [](int fd) { ::close(fd); });
+ *
+ *          // [...]
+ *
+ *          // If the open() succeeded, the file will be closed here.
+ *      }
+ *
+ * Basic interface:
+ *      template <typename R, typename D>
+ *      class unique_resource
+ *      {
+ *      public:
+ *          unique_resource();
+ *
+ *          template <typename RR, typename DD>
+ *          unique_resource(RR&&, DD&&) noexcept(*1);
+ *
+ *          unique_resource(unique_resource&&) noexcept(*2);
+ *
+ *          auto operator=(unique_resource&&) noexcept(*3) -> unique_resource&;
+ *
+ *          auto reset() noexcept -> void;
+ *          template <typename RR>
+ *          auto reset(RR&&) -> void;
+ *
+ *          auto release() noexcept -> void;
+ *
+ *          auto get() const noexcept -> R const&;
+ *          auto get_deleter() const noexcept -> D const&;
+ *
+ *          // Only if R is a pointer type.
+ *          auto operator*() const noexcept -> std::remove_pointer_t<R>&;
+ *          auto operator->() const noexcept -> R;
+ *      };
+ *
+ *      template <typename R, typename D>
+ *      unique_resource(R, D) -> unique_resource<R, D>;
+ *
+ *      template <typename R, typename D, typename S = std::decay_t<R>>
+ *      auto make_unique_resource_checked(R&&, S const&, D&&) noexcept(*4)
+ *          -> unique_resource<std::decay_t<R>, std::decay_t<D>>;
+ *
+ * Notes:
+ *      *1  :   (std::is_nothrow_constructible_v<R1, RR>
+ *                  or std::is_nothrow_constructible_v<R1, RR&>)
+ *              and (std::is_nothrow_constructible_v<D, DD>
+ *                  or std::is_nothrow_constructible_v<D, DD&>)
+ *      *2  :   std::is_nothrow_move_constructible_v<R1>
+ *                  and std::is_nothrow_move_constructible_v<D>
+ *      *3  :   std::is_nothrow_move_assignable_v<R1>
+ *                  and std::is_nothrow_move_assignable_v<D>
+ *      *4  :   std::is_nothrow_constructible_v<std::decay_t<R>, R>
+ *                  and std::is_nothrow_constructible_v<std::decay_t<D>, D>
+ *
+ *      Where R1 is R, or std::reference_wrapper<std::remove_reference_t<R>>
+ *      if R is a reference type.
+ *
+ * The deleter is stored as a [[no_unique_address]] data member, so an empty
+ * deleter (like a captureless lambda) takes no space at all. For example,
+ * `unique_resource<int, D>` with an empty `D` is no larger than an `int`
+ * plus a `bool`.
+ *
+ * Resource handle types that have an "invalid" value (like -1 for POSIX
+ * file descriptors) can opt in to having that value used to track
+ * ownership, instead of a separate flag, by specializing resource_traits:
+ *      enum class fd : int {};
+ *
+ *      template <>
+ *      struct indi::resource_traits<fd>
+ *      {
+ *          static constexpr auto invalid() noexcept -> fd { return fd{-1}; }
+ *      };
+ *
+ * Then `unique_resource<fd, D>` with an empty `D` is exactly the size of an
+ * `int`, and a default constructed one holds the invalid value (even if the
+ * handle type has no default constructor). In this mode, release() (and reset(), and being moved from) set the
+ * stored resource to the invalid value, so get() must be called *before*
+ * release() to take ownership of the resource. Also, a unique_resource
+ * constructed with the invalid value does not own anything, as if it had
+ * been created with make_unique_resource_checked().
+ *
+ ****************************************************************************/
+
+// resource_traits<R>
+//
+// Customization point for resource handle types that have an "invalid"
+// value. Specializations should have a static, noexcept `invalid()`
+// function that returns that value.
+//
+// When resource_traits<R> is specialized, unique_resource<R, D> uses the
+// invalid value to mark that it does not own a resource, rather than
+// storing a separate flag.
+//
+// The primary template is empty, which means there is no invalid value.
+// In particular, there are NO specializations for built-in types like
+// `int` or pointers: an `int` is not always a file descriptor, and the
+// deleter of a unique_resource with a null pointer must still be called
+// (see P0052r10 7.6.1).
+template <typename R>
+struct resource_traits {};
+
+namespace _detail_X_scope {
+
+// has_invalid_resource<R>
+//
+// Whether unique_resource<R, D> should use the invalid value from
+// resource_traits<R> to track ownership. The resource must also be able to
+// be copied and compared without throwing, so that resetting and releasing
+// it stay noexcept.
+template <typename R>
+concept has_invalid_resource =
+	std::is_object_v<R>
+	and std::is_nothrow_copy_constructible_v<R>
+	and std::is_nothrow_move_constructible_v<R>
+	and std::is_nothrow_copy_assignable_v<R>
+	and requires (R const& r)
+	{
+		{ resource_traits<R>::invalid() } noexcept -> std::convertible_to<R>;
+		{ r == resource_traits<R>::invalid() } noexcept -> std::convertible_to<bool>;
+	};
+
+// no_execute_flag
+//
+// Empty type used in place of the "execute on reset" flag of
+// unique_resource, when ownership is tracked by the resource itself.
+struct no_execute_flag {};
+
+// execute_on_reset_tag
+//
+// Tag type to select the unique_resource constructor that allows setting
+// whether the resource is owned at construction.
+struct execute_on_reset_tag
+{
+	bool value;
+};
+
+// on_init_failure<T, U>(F)
+//
+// Returns a guard object that calls the function if it is destroyed during
+// stack unwinding - but only if initializing a `T` with
+// `move_init_if_noexcept<T, U>(u)` may throw. Otherwise, returns an empty
+// object that does nothing.
+//
+// Intended to be used (cast to void) as the left operand of a comma
+// expression in a mem-initializer, so that the guard lives exactly as long
+// as the initialization of the data member:
+//      _t{(static_cast<void>(on_init_failure<T, U>([&u] { cleanup(u); })), move_init_if_noexcept<T, U>(u))}
+// (The cast makes sure the built-in comma operator is used, even if there
+// is an `operator,` for the member's type.)
+struct no_init_failure_guard {};
+
+template <typename T, typename U, typename F>
+constexpr auto on_init_failure(F&& f) noexcept
+{
+#ifdef INDI_X_SCOPE_NO_EXCEPTIONS
+	// Without exceptions, initialization can't fail (recoverably).
+	static_cast<void>(f);
+	return no_init_failure_guard{};
+#else
+	using init_type = decltype(move_init_if_noexcept<T, U>(std::declval<U&>()));
+
+	if constexpr (std::is_nothrow_constructible_v<T, init_type>)
+		return no_init_failure_guard{};
+	else
+		return scope_fail<std::decay_t<F>>{std::forward<F>(f)};
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+}
+
+} // namespace _detail_X_scope
+
+template <typename R, typename D>
+class unique_resource;
+
+template <typename R, typename D, typename S = std::decay_t<R>>
+auto make_unique_resource_checked(R&& r, S const& invalid, D&& d)
+	noexcept(std::is_nothrow_constructible_v<std::decay_t<R>, R> and std::is_nothrow_constructible_v<std::decay_t<D>, D>)
+	-> unique_resource<std::decay_t<R>, std::decay_t<D>>;
+
+// unique_resource<R, D>
+//
+// unique_resource owns a resource handle of type `R`, and calls the deleter
+// of type `D` with that handle when it is destroyed or reset (unless it has
+// been released).
+//
+// Requirements:
+//      *   R is a (possibly const) object type or an lvalue reference type.
+//      *   D is a destructible object type.
+//      *   If `d` is an lvalue of type `D`, and `r` is an lvalue of type
+//          R1, then `d(r)` should be well-formed and should not raise an
+//          exception.
+template <typename R, typename D>
+class unique_resource
+{
+	// 7.6.1 requirements.
+	static_assert(std::is_object_v<R> or std::is_lvalue_reference_v<R>);
+	static_assert(std::is_object_v<D> and std::is_destructible_v<D>);
+
+	// Reference resources are stored as reference wrappers, so that the
+	// unique_resource can be move assigned.
+	using R1 = std::conditional_t<std::is_reference_v<R>, std::reference_wrapper<std::remove_reference_t<R>>, R>;
+
+	static_assert(std::is_move_constructible_v<R1> and std::is_move_constructible_v<D>);
+	static_assert(std::is_invocable_v<D&, R1&>);
+
+	// If the resource has an invalid value, that is used to track ownership.
+	// Otherwise, a flag is used.
+	static constexpr auto _uses_invalid_resource = _detail_X_scope::has_invalid_resource<R>;
+
+	using _execute_flag = std::conditional_t<_uses_invalid_resource, _detail_X_scope::no_execute_flag, bool>;
+
+public:
+	// With an invalid value, the resource is initialized to that, so `R`
+	// doesn't have to be default constructible.
+	unique_resource()
+		noexcept(noexcept(_default_resource()) and std::is_nothrow_default_constructible_v<D>)
+		requires ((_uses_invalid_resource or std::is_default_constructible_v<R>) and std::is_default_constructible_v<D>)
+	:
+		_resource{_default_resource()},
+		_execute_on_reset{},
+		_deleter{}
+	{}
+
+	template <typename RR, typename DD>
+		requires (std::is_constructible_v<R1, RR> and std::is_constructible_v<D, DD>
+			and (std::is_nothrow_constructible_v<R1, RR> or std::is_constructible_v<R1, RR&>)
+			and (std::is_nothrow_constructible_v<D, DD> or std::is_constructible_v<D, DD&>))
+	unique_resource(RR&& r, DD&& d)
+		noexcept((std::is_nothrow_constructible_v<R1, RR> or std::is_nothrow_constructible_v<R1, RR&>)
+			and (std::is_nothrow_constructible_v<D, DD> or std::is_nothrow_constructible_v<D, DD&>))
+	:
+		unique_resource(std::forward<RR>(r), std::forward<DD>(d), _detail_X_scope::execute_on_reset_tag{true})
+	{}
+
+	unique_resource(unique_resource&& other)
+		noexcept(std::is_nothrow_move_constructible_v<R1> and std::is_nothrow_move_constructible_v<D>)
+	:
+		_resource{std::move_if_noexcept(other._resource)},
+		_execute_on_reset{other._release_ownership()},
+		_deleter{(
+			static_cast<void>(_detail_X_scope::on_init_failure<D, D&&>([this, &other]
+			{
+				// If the resource was moved (rather than copied), it is now
+				// owned by this object, so it has to be deleted here.
+				// Otherwise, ownership goes back to the moved-from object.
+				if constexpr (std::is_nothrow_move_constructible_v<R1>)
+				{
+					if (_owns_resource())
+						other._deleter(_resource);
+				}
+				else
+				{
+					other._execute_on_reset = _execute_on_reset;
+				}
+			})),
+			std::move_if_noexcept(other._deleter))}
+	{}
+
+	~unique_resource()
+	{
+		reset();
+	}
+
+	auto operator=(unique_resource&& other)
+		noexcept(std::is_nothrow_move_assignable_v<R1> and std::is_nothrow_move_assignable_v<D>)
+		-> unique_resource&
+		requires ((std::is_nothrow_move_assignable_v<R1> or std::is_copy_assignable_v<R1>)
+			and (std::is_nothrow_move_assignable_v<D> or std::is_copy_assignable_v<D>))
+	{
+		reset();
+
+		// Whichever of the resource and deleter can be moved without
+		// throwing is moved last, so that if the other one throws, the
+		// moved-from object still owns its (unmodified) resource.
+		if constexpr (std::is_nothrow_move_assignable_v<R1>)
+		{
+			if constexpr (std::is_nothrow_move_assignable_v<D>)
+			{
+				_resource = std::move(other._resource);
+				_deleter = std::move(other._deleter);
+			}
+			else
+			{
+				_deleter = other._deleter;
+				_resource = std::move(other._resource);
+			}
+		}
+		else
+		{
+			if constexpr (std::is_nothrow_move_assignable_v<D>)
+			{
+				_resource = other._resource;
+				_deleter = std::move(other._deleter);
+			}
+			else
+			{
+				_resource = other._resource;
+				_deleter = other._deleter;
+			}
+		}
+
+		_execute_on_reset = other._release_ownership();
+
+		return *this;
+	}
+
+	auto reset() noexcept -> void
+	{
+		if (_owns_resource())
+		{
+			if constexpr (_uses_invalid_resource)
+			{
+				auto resource = std::exchange(_resource, resource_traits<R>::invalid());
+				_deleter(resource);
+			}
+			else
+			{
+				_execute_on_reset = false;
+				_deleter(_resource);
+			}
+		}
+	}
+
+	template <typename RR>
+		requires (std::is_nothrow_assignable_v<R1&, RR> or std::is_assignable_v<R1&, RR const&>)
+	auto reset(RR&& r) -> void
+	{
+		reset();
+
+		if constexpr (std::is_nothrow_assignable_v<R1&, RR>)
+		{
+			_resource = std::forward<RR>(r);
+		}
+		else
+		{
+#ifdef INDI_X_SCOPE_NO_EXCEPTIONS
+			_resource = std::as_const(r);
+#else
+			try
+			{
+				_resource = std::as_const(r);
+			}
+			catch (...)
+			{
+				_deleter(r);
+				throw;
+			}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+		}
+
+		if constexpr (not _uses_invalid_resource)
+			_execute_on_reset = true;
+	}
+
+	auto release() noexcept -> void
+	{
+		_release_ownership();
+	}
+
+	auto get() const noexcept -> R const&
+	{
+		if constexpr (std::is_reference_v<R>)
+			return _resource.get();
+		else
+			return _resource;
+	}
+
+	auto operator*() const noexcept -> std::add_lvalue_reference_t<std::remove_pointer_t<R>>
+		requires (std::is_pointer_v<R> and not std::is_void_v<std::remove_pointer_t<R>>)
+	{
+		return *get();
+	}
+
+	auto operator->() const noexcept -> R
+		requires std::is_pointer_v<R>
+	{
+		return get();
+	}
+
+	auto get_deleter() const noexcept -> D const&
+	{
+		return _deleter;
+	}
+
+private:
+	template <typename RR, typename DD, typename S>
+	friend auto make_unique_resource_checked(RR&& r, S const& invalid, DD&& d)
+		noexcept(std::is_nothrow_constructible_v<std::decay_t<RR>, RR> and std::is_nothrow_constructible_v<std::decay_t<DD>, DD>)
+		-> unique_resource<std::decay_t<RR>, std::decay_t<DD>>;
+
+	// Constructor that allows setting whether the resource is owned at
+	// construction. Only used by `make_unique_resource_checked()`.
+	template <typename RR, typename DD>
+	unique_resource(RR&& r, DD&& d, _detail_X_scope::execute_on_reset_tag execute)
+		noexcept((std::is_nothrow_constructible_v<R1, RR> or std::is_nothrow_constructible_v<R1, RR&>)
+			and (std::is_nothrow_constructible_v<D, DD> or std::is_nothrow_constructible_v<D, DD&>))
+	:
+		// 7.6.1.6: If initialization of the resource throws, call `d(r)`.
+		_resource{(
+			static_cast<void>(_detail_X_scope::on_init_failure<R1, RR>([&r, &d, execute]
+			{
+				if (execute.value)
+					d(r);
+			})),
+			_detail_X_scope::move_init_if_noexcept<R1, RR>(r))},
+		_execute_on_reset{_initial_execute_flag(execute.value)},
+		// 7.6.1.6: If initialization of the deleter throws, call
+		// `d(resource)`.
+		_deleter{(
+			static_cast<void>(_detail_X_scope::on_init_failure<D, DD>([this, &d, execute]
+			{
+				if (execute.value)
+					d(_resource);
+			})),
+			_detail_X_scope::move_init_if_noexcept<D, DD>(d))}
+	{
+		if constexpr (_uses_invalid_resource)
+		{
+			if (not execute.value)
+				_resource = resource_traits<R>::invalid();
+		}
+	}
+
+	static constexpr auto _default_resource() noexcept(_uses_invalid_resource or std::is_nothrow_default_constructible_v<R1>) -> R1
+	{
+		if constexpr (_uses_invalid_resource)
+			return resource_traits<R>::invalid();
+		else
+			return R1{};
+	}
+
+	static constexpr auto _initial_execute_flag(bool execute) noexcept -> _execute_flag
+	{
+		if constexpr (_uses_invalid_resource)
+			return {};
+		else
+			return execute;
+	}
+
+	auto _owns_resource() const noexcept -> bool
+	{
+		if constexpr (_uses_invalid_resource)
+			return not bool(_resource == resource_traits<R>::invalid());
+		else
+			return _execute_on_reset;
+	}
+
+	// Gives up ownership of the resource (without calling the deleter), and
+	// returns the previous value of the execute flag.
+	auto _release_ownership() noexcept -> _execute_flag
+	{
+		if constexpr (_uses_invalid_resource)
+		{
+			_resource = resource_traits<R>::invalid();
+			return {};
+		}
+		else
+		{
+			return std::exchange(_execute_on_reset, false);
+		}
+	}
+
+	// The flag is placed directly after the resource (rather than after the
+	// deleter), so that when the deleter is not empty and is more aligned
+	// than the resource, the flag goes in the padding between the two
+	// instead of adding padding at the end. (The resource is not
+	// [[no_unique_address]], so its own tail padding is never reused.) With
+	// an invalid value, the flag is empty and takes no space.
+	R1 _resource;
+	[[no_unique_address]] _execute_flag _execute_on_reset = {};
+	[[no_unique_address]] D _deleter;
+};
+
+template <typename R, typename D>
+unique_resource(R, D) -> unique_resource<R, D>;
+
+// make_unique_resource_checked(R&&, S const&, D&&)
+//
+// Creates a unique_resource that owns the resource only if it does not
+// compare equal to the given invalid value. This is useful for C library
+// functions that return a sentinel value on failure (like `open()`
+// returning -1, or `fopen()` returning a null pointer).
+template <typename R, typename D, typename S>
+auto make_unique_resource_checked(R&& r, S const& invalid, D&& d)
+	noexcept(std::is_nothrow_constructible_v<std::decay_t<R>, R> and std::is_nothrow_constructible_v<std::decay_t<D>, D>)
+	-> unique_resource<std::decay_t<R>, std::decay_t<D>>
+{
+	// 7.6.2 requirements.
+	static_assert(std::is_convertible_v<decltype(r == invalid), bool>);
+
+	auto const execute = not bool(r == invalid);
+
+	return unique_resource<std::decay_t<R>, std::decay_t<D>>(
+		std::forward<R>(r),
+		std::forward<D>(d),
+		_detail_X_scope::execute_on_reset_tag{execute});
+}
 
 } // inline namespace v1
 } // namespace indi
@@ -216,6 +216,59 @@ using all_functors = std::tuple<
 	immobile_functor_t<T>
 >;
 
+/*****************************************************************************
+ * Test function.
+ *
+ * Because it is a function, rather than a function object, it cannot hold
+ * a reference to a counter. Instead, each time it is called, it increments
+ * a global counter.
+ ****************************************************************************/
+
+inline auto function_call_count = 0;
+
+inline auto function() -> void { ++function_call_count; }
+
+/*****************************************************************************
+ * Test deleters.
+ *
+ * Deleters for use with unique_resource. Like the test function objects,
+ * they take a reference to a counter `int`, which is incremented each time
+ * the deleter is called. They also record the last resource they were
+ * called with.
+ ****************************************************************************/
+
+// Basic deleter.
+template <typename T>
+class deleter_t
+{
+public:
+	constexpr explicit deleter_t(T& counter, T& last_resource) noexcept :
+		_p_counter{&counter},
+		_p_last_resource{&last_resource}
+	{}
+
+	auto operator()(T resource) const noexcept
+	{
+		++(*_p_counter);
+		*_p_last_resource = resource;
+	}
+
+private:
+	T* _p_counter = nullptr;
+	T* _p_last_resource = nullptr;
+};
+
+// Deleter with no state.
+//
+// Because it has no state, it uses a global counter.
+struct empty_deleter_t
+{
+	static inline auto call_count = 0;
+
+	template <typename T>
+	auto operator()(T const&) const noexcept { ++call_count; }
+};
+
 } // namespace indi_test
 
 #endif // include guard
@@ -0,0 +1,77 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+// Compares a group of scope_fail guards that each query the number of
+// uncaught exceptions on creation, with the same group sharing a single
+// scope_checkpoint.
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.bench.hpp>
+
+namespace {
+
+constexpr auto guard_count = 8;
+
+int counter = 0;
+
+auto undo() noexcept -> void { ++counter; }
+
+[[gnu::noinline]] auto individual() -> void
+{
+	auto const s1 = indi::scope_fail{undo};
+	auto const s2 = indi::scope_fail{undo};
+	auto const s3 = indi::scope_fail{undo};
+	auto const s4 = indi::scope_fail{undo};
+	auto const s5 = indi::scope_fail{undo};
+	auto const s6 = indi::scope_fail{undo};
+	auto const s7 = indi::scope_fail{undo};
+	auto const s8 = indi::scope_fail{undo};
+
+	indi_bench::clobber_memory();
+}
+
+[[gnu::noinline]] auto shared_checkpoint() -> void
+{
+	auto const checkpoint = indi::scope_checkpoint{};
+
+	auto const s1 = indi::scope_fail{checkpoint, undo};
+	auto const s2 = indi::scope_fail{checkpoint, undo};
+	auto const s3 = indi::scope_fail{checkpoint, undo};
+	auto const s4 = indi::scope_fail{checkpoint, undo};
+	auto const s5 = indi::scope_fail{checkpoint, undo};
+	auto const s6 = indi::scope_fail{checkpoint, undo};
+	auto const s7 = indi::scope_fail{checkpoint, undo};
+	auto const s8 = indi::scope_fail{checkpoint, undo};
+
+	indi_bench::clobber_memory();
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+	auto const t_individual = indi_bench::measure(individual);
+	auto const t_shared = indi_bench::measure(shared_checkpoint);
+
+	indi_bench::report("scope_fail x8 (per guard)", t_individual / guard_count);
+	indi_bench::report("scope_fail x8, shared checkpoint (per guard)", t_shared / guard_count);
+
+	indi_bench::do_not_optimize(counter);
+}
@@ -0,0 +1,383 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#ifndef INDI_INC_scope_coroutine
+#define INDI_INC_scope_coroutine
+
+/*****************************************************************************
+ * Coroutine-aware scope guards
+ *
+ * scope_fail and scope_success compare the number of uncaught exceptions on
+ * destruction with the number on construction. That only works if both
+ * happen in the same context. In a coroutine, the guard may be constructed
+ * before a suspension and destroyed after the coroutine is resumed on
+ * another thread, or from a destructor that is running during another
+ * thread's (or another coroutine's) stack unwinding. Then the two counts
+ * have nothing to do with each other, and the guard misfires.
+ *
+ * coroutine_scope_fail and coroutine_scope_success instead get the failure
+ * state from the coroutine: the promise type derives from
+ * coroutine_scope_state, which records the number of uncaught exceptions
+ * each time the coroutine is resumed. A guard is then destroyed by failure
+ * if an exception is propagating out of the current resumption (or if the
+ * coroutine is destroyed while suspended, which means it never finished):
+ *      struct promise_type : indi::coroutine_scope_state
+ *      {
+ *          auto initial_suspend() noexcept { return track(std::suspend_always{}); }
+ *          // [...]
+ *      };
+ *
+ *      auto f() -> task
+ *      {
+ *          auto& scope = co_await indi::this_coroutine_scope;
+ *
+ *          auto const _ = indi::coroutine_scope_fail{scope, [] { rollback(); }};
+ *
+ *          co_await step_1();  // may resume on any thread
+ *          co_await step_2();
+ *      }
+ *
+ * A promise type that derives from coroutine_scope_state gets an
+ * `await_transform()` that wraps every awaitable with `track()`. If the
+ * promise type has its own `await_transform()`, that should return
+ * `track(...)` of its result. `co_yield` doesn't go through
+ * `await_transform()`, so `yield_value()` must return `track(...)` of its
+ * awaiter too:
+ *      auto yield_value(T value) noexcept
+ *      {
+ *          _value = std::move(value);
+ *          return track(std::suspend_always{});
+ *      }
+ *
+ * Without that, a generator that is destroyed while suspended at a `co_yield`
+ * during stack unwinding, or resumed on another thread, would use a stale
+ * number of uncaught exceptions, and its guards would misfire. If
+ * `initial_suspend()` may suspend, its result should also be wrapped with
+ * `track()`; `final_suspend()` doesn't need to be, because the body's guards
+ * have all been destroyed by then.
+ *
+ * Otherwise, the guards work like scope_fail and scope_success: they can be
+ * released or moved (but not out of the coroutine), and if initializing the
+ * exit function throws, coroutine_scope_fail calls it.
+ ****************************************************************************/
+
+#include <coroutine>
+#include <type_traits>
+#include <utility>
+
+#include <indi/scope.hpp>
+
+namespace indi {
+inline namespace v1 {
+
+class coroutine_scope_state;
+
+namespace _detail_X_scope {
+
+// get_awaiter(a)
+//
+// Returns the awaiter for the operand of a `co_await` expression (after any
+// `await_transform()`): the result of its `operator co_await()` if it has
+// one, otherwise the operand itself.
+template <typename A>
+constexpr auto get_awaiter(A&& a) -> decltype(auto)
+{
+	if constexpr (requires { std::forward<A>(a).operator co_await(); })
+		return std::forward<A>(a).operator co_await();
+	else if constexpr (requires { operator co_await(std::forward<A>(a)); })
+		return operator co_await(std::forward<A>(a));
+	else
+		return std::forward<A>(a);
+}
+
+// tracking_awaiter<Awaiter>
+//
+// Wraps an awaiter, and tells the coroutine_scope_state when the coroutine
+// is suspended and resumed.
+//
+// `Awaiter` is a reference if the operand of `co_await` was an awaiter
+// (which lives until the end of the `co_await` expression anyway), or an
+// object type if `operator co_await()` returned one. It's an aggregate, so
+// non-movable awaiters can be wrapped.
+template <typename Awaiter>
+struct tracking_awaiter
+{
+	Awaiter _awaiter;
+	coroutine_scope_state* _p_state;
+
+	auto await_ready() -> bool
+	{
+		return _awaiter.await_ready();
+	}
+
+	template <typename P>
+	auto await_suspend(std::coroutine_handle<P> h) -> decltype(auto);
+
+	auto await_resume() -> decltype(auto);
+};
+
+// this_coroutine_scope_t
+//
+// Type of the this_coroutine_scope tag.
+struct this_coroutine_scope_t
+{
+	explicit this_coroutine_scope_t() = default;
+};
+
+} // namespace _detail_X_scope
+
+// this_coroutine_scope
+//
+// `co_await this_coroutine_scope` in a coroutine whose promise type derives
+// from coroutine_scope_state returns a reference to that state (without
+// suspending).
+inline constexpr auto this_coroutine_scope = _detail_X_scope::this_coroutine_scope_t{};
+
+// coroutine_scope_state
+//
+// Base class for coroutine promise types, that tracks whether the coroutine
+// is running, and the number of uncaught exceptions when it was last
+// resumed (on whichever thread that was).
+class coroutine_scope_state
+{
+public:
+	// The promise is constructed just before the coroutine starts, in the
+	// same context, which counts as the first resumption (if the coroutine
+	// doesn't suspend initially).
+	coroutine_scope_state() noexcept
+	{
+		_on_resume();
+	}
+
+	coroutine_scope_state(coroutine_scope_state const&) = delete;
+	auto operator=(coroutine_scope_state const&) -> coroutine_scope_state& = delete;
+
+	// Whether the coroutine is running (as opposed to suspended).
+	constexpr auto running() const noexcept -> bool
+	{
+		return _running;
+	}
+
+	// The number of exceptions that were thrown since the coroutine was last
+	// resumed, and haven't been caught yet (or 0 if it is suspended).
+	auto uncaught_in_coroutine() const noexcept -> int
+	{
+		return _running ? _detail_X_scope::uncaught_exceptions() - _uncaught_on_resume : 0;
+	}
+
+	// Whether a scope that was entered when `uncaught_in_coroutine()` was
+	// `uncaught_on_entry` is being exited by failure: either via stack
+	// unwinding, or because the coroutine is being destroyed while
+	// suspended.
+	auto unwinding(int uncaught_on_entry = 0) const noexcept -> bool
+	{
+		return not _running or uncaught_in_coroutine() > uncaught_on_entry;
+	}
+
+	// Wraps an awaitable, so that the state is updated when the coroutine is
+	// suspended and resumed by it.
+	template <typename A>
+	auto track(A&& a) noexcept(noexcept(_detail_X_scope::get_awaiter(std::forward<A>(a))))
+	{
+		using awaiter_type = decltype(_detail_X_scope::get_awaiter(std::forward<A>(a)));
+
+		return _detail_X_scope::tracking_awaiter<awaiter_type>{_detail_X_scope::get_awaiter(std::forward<A>(a)), this};
+	}
+
+	template <typename A>
+	auto await_transform(A&& a) noexcept(noexcept(track(std::forward<A>(a))))
+	{
+		return track(std::forward<A>(a));
+	}
+
+	auto await_transform(_detail_X_scope::this_coroutine_scope_t) noexcept
+	{
+		struct awaiter
+		{
+			coroutine_scope_state& _state;
+
+			constexpr auto await_ready() const noexcept -> bool { return true; }
+			constexpr auto await_suspend(std::coroutine_handle<>) const noexcept -> void {}
+			constexpr auto await_resume() const noexcept -> coroutine_scope_state& { return _state; }
+		};
+
+		return awaiter{*this};
+	}
+
+protected:
+	~coroutine_scope_state() = default;
+
+private:
+	template <typename Awaiter>
+	friend struct _detail_X_scope::tracking_awaiter;
+
+	auto _on_resume() noexcept -> void
+	{
+		_uncaught_on_resume = _detail_X_scope::uncaught_exceptions();
+		_running = true;
+	}
+
+	auto _on_suspend() noexcept -> void
+	{
+		_running = false;
+	}
+
+	int _uncaught_on_resume = 0;
+	bool _running = false;
+};
+
+namespace _detail_X_scope {
+
+// The state is marked as suspended before calling the wrapped
+// `await_suspend()`, because after that, the coroutine may already be
+// running on another thread. If `await_suspend()` throws, the coroutine is
+// resumed with the exception.
+template <typename Awaiter>
+template <typename P>
+auto tracking_awaiter<Awaiter>::await_suspend(std::coroutine_handle<P> h) -> decltype(auto)
+{
+	_p_state->_on_suspend();
+
+#ifdef INDI_X_SCOPE_NO_EXCEPTIONS
+	return _awaiter.await_suspend(h);
+#else
+	try
+	{
+		return _awaiter.await_suspend(h);
+	}
+	catch (...)
+	{
+		_p_state->_on_resume();
+		throw;
+	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+}
+
+template <typename Awaiter>
+auto tracking_awaiter<Awaiter>::await_resume() -> decltype(auto)
+{
+	_p_state->_on_resume();
+	return _awaiter.await_resume();
+}
+
+// coroutine_scope_guard<EF, CallOnFailure>
+//
+// Implementation of coroutine_scope_fail (CallOnFailure is true) and
+// coroutine_scope_success (CallOnFailure is false).
+template <typename EF, bool CallOnFailure>
+class coroutine_scope_guard : public scope_guard_base<EF>
+{
+	template <typename EFP>
+	static constexpr auto _needs_init_failure_handler =
+		CallOnFailure and needs_init_failure_handler_v<EF, EFP>;
+
+public:
+	template <typename EFP>
+		requires (not _needs_init_failure_handler<EFP>)
+	coroutine_scope_guard(coroutine_scope_state const& state, EFP&& f)
+		noexcept(is_nothrow_exit_function_init_v<EF, EFP>)
+	:
+		_exit_function{move_init_if_noexcept<EF, EFP>(f)},
+		_p_state{std::addressof(state)},
+		_uncaught_on_creation{state.uncaught_in_coroutine()}
+	{
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+	template <typename EFP>
+		requires (_needs_init_failure_handler<EFP>)
+	coroutine_scope_guard(coroutine_scope_state const& state, EFP&& f)
+	try :
+		_exit_function{move_init_if_noexcept<EF, EFP>(f)},
+		_p_state{std::addressof(state)},
+		_uncaught_on_creation{state.uncaught_in_coroutine()}
+	{
+		static_assert(std::is_nothrow_constructible_v<EF, EFP> or std::is_constructible_v<EF, EFP&>);
+	}
+	catch (...)
+	{
+		f();
+	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+
+	coroutine_scope_guard(coroutine_scope_guard&& other)
+		noexcept(std::is_nothrow_move_constructible_v<EF> or std::is_nothrow_copy_constructible_v<EF>)
+	:
+		_exit_function{std::move(other._exit_function)},
+		_p_state{other._p_state},
+		_uncaught_on_creation{other._uncaught_on_creation}
+	{
+		other.release();
+	}
+
+	~coroutine_scope_guard()
+		noexcept(noexcept(_exit_function()))
+	{
+		if (_exit_function.is_armed() and _p_state->unwinding(_uncaught_on_creation) == CallOnFailure)
+			_exit_function();
+	}
+
+	auto release() noexcept -> void
+	{
+		_exit_function.disarm();
+	}
+
+private:
+	exit_function_storage<EF> _exit_function;
+	coroutine_scope_state const* _p_state = nullptr;
+	int _uncaught_on_creation = 0;
+};
+
+} // namespace _detail_X_scope
+
+// coroutine_scope_fail<EF>
+//
+// coroutine_scope_fail is a scope guard for use in a coroutine, that calls
+// its contained function only if the coroutine exits its scope via stack
+// unwinding, or is destroyed while suspended.
+template <typename EF>
+class coroutine_scope_fail : public _detail_X_scope::coroutine_scope_guard<EF, true>
+{
+public:
+	using _detail_X_scope::coroutine_scope_guard<EF, true>::coroutine_scope_guard;
+};
+
+template <typename EF>
+coroutine_scope_fail(coroutine_scope_state const&, EF) -> coroutine_scope_fail<EF>;
+
+// coroutine_scope_success<EF>
+//
+// coroutine_scope_success is a scope guard for use in a coroutine, that
+// calls its contained function only if the coroutine exits its scope
+// normally.
+template <typename EF>
+class coroutine_scope_success : public _detail_X_scope::coroutine_scope_guard<EF, false>
+{
+public:
+	using _detail_X_scope::coroutine_scope_guard<EF, false>::coroutine_scope_guard;
+};
+
+template <typename EF>
+coroutine_scope_success(coroutine_scope_state const&, EF) -> coroutine_scope_success<EF>;
+
+} // inline namespace v1
+} // namespace indi
+
+#endif // include guard
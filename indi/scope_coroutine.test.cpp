@@ -0,0 +1,496 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#define BOOST_TEST_MODULE scope_coroutine
+#ifdef BOOST_TEST_DYN_LINK
+#	include <boost/test/unit_test.hpp>
+#else
+#	include <boost/test/included/unit_test.hpp>
+#endif // BOOST_TEST_DYN_LINK
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <indi/scope_coroutine.hpp>
+
+#include <indi/scope.test.hpp>
+
+namespace {
+
+/*****************************************************************************
+ * Minimal task type.
+ *
+ * The coroutine starts suspended, and is resumed (and destroyed) by hand by
+ * the test, on whatever thread and in whatever context the test needs.
+ ****************************************************************************/
+
+class task
+{
+public:
+	struct promise_type : indi::coroutine_scope_state
+	{
+		std::exception_ptr exception;
+
+		auto get_return_object() -> task { return task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+
+		auto initial_suspend() noexcept { return track(std::suspend_always{}); }
+		auto final_suspend() noexcept -> std::suspend_always { return {}; }
+
+		auto yield_value(int) noexcept { return track(std::suspend_always{}); }
+
+		auto return_void() noexcept -> void {}
+		auto unhandled_exception() noexcept -> void { exception = std::current_exception(); }
+	};
+
+	task(task&& other) noexcept : _handle{std::exchange(other._handle, {})} {}
+
+	~task()
+	{
+		if (_handle)
+			_handle.destroy();
+	}
+
+	// Resumes the coroutine (on the current thread).
+	auto resume() -> void { _handle.resume(); }
+
+	// Resumes the coroutine on a new thread, and waits for it.
+	auto resume_on_other_thread() -> void { std::thread{[h = _handle] { h.resume(); }}.join(); }
+
+	// Resumes the coroutine from the destructor of an object destroyed by
+	// stack unwinding (so with an uncaught exception in flight, that has
+	// nothing to do with the coroutine).
+	auto resume_during_unwinding() -> void
+	{
+		struct resume_on_destruction
+		{
+			std::coroutine_handle<> handle;
+			~resume_on_destruction() { handle.resume(); }
+		};
+
+		try
+		{
+			auto const _ = resume_on_destruction{_handle};
+			throw indi_test::exception{};
+		}
+		catch (indi_test::exception const&)
+		{
+		}
+	}
+
+	// Destroys the coroutine (wherever it is suspended).
+	auto destroy() -> void { std::exchange(_handle, {}).destroy(); }
+
+	// Destroys the coroutine from the destructor of an object destroyed by
+	// stack unwinding.
+	auto destroy_during_unwinding() -> void
+	{
+		struct destroy_on_destruction
+		{
+			std::coroutine_handle<> handle;
+			~destroy_on_destruction() { handle.destroy(); }
+		};
+
+		try
+		{
+			auto const _ = destroy_on_destruction{std::exchange(_handle, {})};
+			throw indi_test::exception{};
+		}
+		catch (indi_test::exception const&)
+		{
+		}
+	}
+
+	auto done() const -> bool { return _handle.done(); }
+
+	auto failed() const -> bool { return static_cast<bool>(_handle.promise().exception); }
+
+private:
+	explicit task(std::coroutine_handle<promise_type> handle) noexcept : _handle{handle} {}
+
+	std::coroutine_handle<promise_type> _handle;
+};
+
+// Coroutine with a coroutine_scope_fail and a coroutine_scope_success, that
+// suspends once (after both guards are constructed), and then throws if
+// `should_throw` is set.
+auto guarded_coroutine(int& fail_count, int& success_count, bool const& should_throw) -> task
+{
+	auto& scope = co_await indi::this_coroutine_scope;
+
+	auto const _1 = indi::coroutine_scope_fail{scope, indi_test::functor_t<int>{fail_count}};
+	auto const _2 = indi::coroutine_scope_success{scope, indi_test::functor_t<int>{success_count}};
+
+	co_await std::suspend_always{};
+
+	if (should_throw)
+		throw indi_test::exception{};
+}
+
+} // anonymous namespace
+
+/*****************************************************************************
+ * Basic operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(basic_operation_CASE_success)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = false;
+
+	auto t = guarded_coroutine(fail_count, success_count, should_throw);
+	t.resume();
+	BOOST_TEST(fail_count == 0, "function called before scope exit");
+	BOOST_TEST(success_count == 0, "function called before scope exit");
+
+	t.resume();
+	BOOST_TEST(t.done());
+	BOOST_TEST(not t.failed());
+	BOOST_TEST(fail_count == 0);
+	BOOST_TEST(success_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(basic_operation_CASE_fail)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = true;
+
+	auto t = guarded_coroutine(fail_count, success_count, should_throw);
+	t.resume();
+	t.resume();
+	BOOST_TEST(t.done());
+	BOOST_TEST(t.failed());
+	BOOST_TEST(fail_count == 1);
+	BOOST_TEST(success_count == 0);
+}
+
+// A coroutine that is destroyed while suspended never finished, so that
+// counts as failure.
+BOOST_AUTO_TEST_CASE(basic_operation_CASE_destroyed_while_suspended)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = false;
+
+	auto t = guarded_coroutine(fail_count, success_count, should_throw);
+	t.resume();
+	t.destroy();
+	BOOST_TEST(fail_count == 1);
+	BOOST_TEST(success_count == 0);
+}
+
+/*****************************************************************************
+ * Resumption in another context.
+ *
+ * These are the cases where scope_fail and scope_success misfire, because
+ * the number of uncaught exceptions on construction and destruction are
+ * counted in unrelated contexts.
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(resumed_on_other_thread_CASE_success)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = false;
+
+	auto t = guarded_coroutine(fail_count, success_count, should_throw);
+	t.resume();
+	t.resume_on_other_thread();
+	BOOST_TEST(t.done());
+	BOOST_TEST(fail_count == 0);
+	BOOST_TEST(success_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(resumed_on_other_thread_CASE_fail)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = true;
+
+	auto t = guarded_coroutine(fail_count, success_count, should_throw);
+	t.resume_on_other_thread();
+	t.resume_on_other_thread();
+	BOOST_TEST(t.done());
+	BOOST_TEST(t.failed());
+	BOOST_TEST(fail_count == 1);
+	BOOST_TEST(success_count == 0);
+}
+
+// Completing normally while another exception is in flight (on the resuming
+// thread) is still success.
+BOOST_AUTO_TEST_CASE(resumed_during_unwinding_CASE_success)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = false;
+
+	auto t = guarded_coroutine(fail_count, success_count, should_throw);
+	t.resume();
+	std::thread{[&] { t.resume_during_unwinding(); }}.join();
+	BOOST_TEST(t.done());
+	BOOST_TEST(fail_count == 0);
+	BOOST_TEST(success_count == 1);
+}
+
+// Guards constructed while another exception was in flight still detect an
+// exception thrown after the coroutine is resumed normally.
+BOOST_AUTO_TEST_CASE(created_during_unwinding_CASE_fail)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = true;
+
+	auto t = guarded_coroutine(fail_count, success_count, should_throw);
+	t.resume_during_unwinding();
+	t.resume_on_other_thread();
+	BOOST_TEST(t.done());
+	BOOST_TEST(t.failed());
+	BOOST_TEST(fail_count == 1);
+	BOOST_TEST(success_count == 0);
+}
+
+/*****************************************************************************
+ * Suspension at `co_yield`
+ *
+ * `co_yield` doesn't go through `await_transform()`, so these only work
+ * because `yield_value()` returns `track(...)` of its awaiter.
+ ****************************************************************************/
+
+// Same as guarded_coroutine(), but suspends with `co_yield`.
+auto yielding_coroutine(int& fail_count, int& success_count, bool const& should_throw) -> task
+{
+	auto& scope = co_await indi::this_coroutine_scope;
+
+	auto const _1 = indi::coroutine_scope_fail{scope, indi_test::functor_t<int>{fail_count}};
+	auto const _2 = indi::coroutine_scope_success{scope, indi_test::functor_t<int>{success_count}};
+
+	co_yield 1;
+
+	if (should_throw)
+		throw indi_test::exception{};
+}
+
+BOOST_AUTO_TEST_CASE(yield_CASE_resumed_during_unwinding)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = false;
+
+	auto t = yielding_coroutine(fail_count, success_count, should_throw);
+	t.resume();
+	t.resume_during_unwinding();
+	BOOST_TEST(t.done());
+	BOOST_TEST(fail_count == 0);
+	BOOST_TEST(success_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(yield_CASE_resumed_on_other_thread)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = true;
+
+	auto t = yielding_coroutine(fail_count, success_count, should_throw);
+	t.resume_during_unwinding();
+	t.resume_on_other_thread();
+	BOOST_TEST(t.done());
+	BOOST_TEST(t.failed());
+	BOOST_TEST(fail_count == 1);
+	BOOST_TEST(success_count == 0);
+}
+
+// Destroyed while suspended at the `co_yield`, so the coroutine never
+// finished, even though the number of uncaught exceptions is the same as
+// when it was last resumed.
+BOOST_AUTO_TEST_CASE(yield_CASE_destroyed_during_unwinding)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto should_throw = false;
+
+	auto t = yielding_coroutine(fail_count, success_count, should_throw);
+	t.resume_during_unwinding();
+	std::thread{[&] { t.destroy_during_unwinding(); }}.join();
+	BOOST_TEST(fail_count == 1);
+	BOOST_TEST(success_count == 0);
+}
+
+/*****************************************************************************
+ * Scopes inside the coroutine
+ ****************************************************************************/
+
+// A scope that is exited via an exception that is caught inside the
+// coroutine fails, and the enclosing scope doesn't.
+auto nested_coroutine(int& inner_fail_count, int& outer_fail_count, int& outer_success_count) -> task
+{
+	auto& scope = co_await indi::this_coroutine_scope;
+
+	auto const _1 = indi::coroutine_scope_fail{scope, indi_test::functor_t<int>{outer_fail_count}};
+	auto const _2 = indi::coroutine_scope_success{scope, indi_test::functor_t<int>{outer_success_count}};
+
+	try
+	{
+		auto const _ = indi::coroutine_scope_fail{scope, indi_test::functor_t<int>{inner_fail_count}};
+
+		co_await std::suspend_always{};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+	}
+
+	co_await std::suspend_always{};
+}
+
+BOOST_AUTO_TEST_CASE(nested_scope_CASE_inner_fail)
+{
+	auto inner_fail_count = 0;
+	auto outer_fail_count = 0;
+	auto outer_success_count = 0;
+
+	auto t = nested_coroutine(inner_fail_count, outer_fail_count, outer_success_count);
+	t.resume();
+	t.resume_on_other_thread();
+	BOOST_TEST(inner_fail_count == 1);
+	BOOST_TEST(outer_fail_count == 0);
+
+	t.resume_during_unwinding();
+	BOOST_TEST(t.done());
+	BOOST_TEST(outer_fail_count == 0);
+	BOOST_TEST(outer_success_count == 1);
+}
+
+/*****************************************************************************
+ * Release and move tests
+ ****************************************************************************/
+
+auto released_coroutine(int& call_count) -> task
+{
+	auto& scope = co_await indi::this_coroutine_scope;
+
+	auto guard = indi::coroutine_scope_fail{scope, indi_test::functor_t<int>{call_count}};
+
+	co_await std::suspend_always{};
+
+	guard.release();
+	throw indi_test::exception{};
+}
+
+BOOST_AUTO_TEST_CASE(release_operation)
+{
+	auto call_count = 0;
+
+	auto t = released_coroutine(call_count);
+	t.resume();
+	t.resume();
+	BOOST_TEST(t.failed());
+	BOOST_TEST(call_count == 0, "function called despite release");
+}
+
+auto moved_coroutine(int& call_count) -> task
+{
+	using guard_type = indi::coroutine_scope_success<indi_test::functor_t<int>>;
+
+	auto& scope = co_await indi::this_coroutine_scope;
+
+	auto p_guard_1 = std::unique_ptr<guard_type>{new guard_type{scope, indi_test::functor_t<int>{call_count}}};
+
+	co_await std::suspend_always{};
+
+	auto p_guard_2 = std::unique_ptr<guard_type>{new guard_type{std::move(*p_guard_1)}};
+	p_guard_1.reset();
+	BOOST_TEST(call_count == 0, "function called by moved-from scope guard");
+}
+
+BOOST_AUTO_TEST_CASE(moving)
+{
+	auto call_count = 0;
+
+	auto t = moved_coroutine(call_count);
+	t.resume();
+	t.resume_on_other_thread();
+	BOOST_TEST(t.done());
+	BOOST_TEST(call_count == 1);
+}
+
+/*****************************************************************************
+ * Awaitables are passed through unchanged.
+ ****************************************************************************/
+
+struct value_awaiter
+{
+	int value;
+
+	auto await_ready() const noexcept -> bool { return true; }
+	auto await_suspend(std::coroutine_handle<>) const noexcept -> void {}
+	auto await_resume() const noexcept -> int { return value; }
+};
+
+struct value_awaitable
+{
+	int value;
+
+	auto operator co_await() const noexcept -> value_awaiter { return {value}; }
+};
+
+auto awaiting_coroutine(int& result) -> task
+{
+	auto const awaiter = value_awaiter{1};
+
+	result = co_await awaiter;
+	result += co_await value_awaiter{10};
+	result += co_await value_awaitable{100};
+}
+
+BOOST_AUTO_TEST_CASE(await_transform)
+{
+	auto result = 0;
+
+	auto t = awaiting_coroutine(result);
+	t.resume();
+	BOOST_TEST(t.done());
+	BOOST_TEST(result == 111);
+}
+
+/*****************************************************************************
+ * Special operations
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(not_default_constructible, Func, indi_test::all_functors<int>)
+{
+	BOOST_TEST(not std::is_default_constructible_v<indi::coroutine_scope_fail<Func>>);
+	BOOST_TEST(not std::is_default_constructible_v<indi::coroutine_scope_success<Func&>>);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(not_copy_constructible, Func, indi_test::all_functors<int>)
+{
+	BOOST_TEST(not std::is_copy_constructible_v<indi::coroutine_scope_fail<Func>>);
+	BOOST_TEST(not std::is_copy_constructible_v<indi::coroutine_scope_success<Func&>>);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(not_move_assignable, Func, indi_test::all_functors<int>)
+{
+	BOOST_TEST(not std::is_move_assignable_v<indi::coroutine_scope_fail<Func>>);
+	BOOST_TEST(not std::is_move_assignable_v<indi::coroutine_scope_success<Func&>>);
+}
@@ -24,7 +24,11 @@
 #	include <boost/test/included/unit_test.hpp>
 #endif // BOOST_TEST_DYN_LINK
 
+#include <cstring>
 #include <memory>
+#include <new>
+#include <string>
+#include <vector>
 
 #include <indi/scope.hpp>
 
@@ -318,6 +322,1035 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(
 	BOOST_TEST(call_count == 0, "function called despite release");
 }
 
+/*****************************************************************************
+ * Function pointer and function reference tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(basic_operation_WITH_function_pointer)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit{&indi_test::function};
+		BOOST_TEST(indi_test::function_call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(basic_operation_WITH_function_reference)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit<void(&)()>{indi_test::function};
+		BOOST_TEST(indi_test::function_call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(release_operation_WITH_function_pointer)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit{&indi_test::function};
+
+		scope_guard.release();
+		BOOST_TEST(indi_test::function_call_count == 0, "function called by release");
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 0, "function called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(moving_WITH_function_pointer)
+{
+	using scope_exit_ptr = std::unique_ptr<indi::scope_exit<void(*)()>>;
+
+	indi_test::function_call_count = 0;
+
+	auto p_scope_guard_1 = scope_exit_ptr{new indi::scope_exit{&indi_test::function}};
+
+	auto p_scope_guard_2 = scope_exit_ptr{new indi::scope_exit{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(indi_test::function_call_count == 0, "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(indi_test::function_call_count == 0, "function called by releasing moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+/*****************************************************************************
+ * Storage tests
+ *
+ * When the exit function is stored as a pointer (for lvalue references and
+ * function pointers), a null pointer is used as the released state, so no
+ * extra flag is needed.
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(size_WITH_lvalue, Func, indi_test::all_functors<int>)
+{
+	BOOST_TEST(sizeof(indi::scope_exit<Func&>) == sizeof(Func*));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(size_WITH_rvalue, Func, indi_test::rvalue_functors<int>)
+{
+	// A function object has no spare value to use as the released state, so
+	// a flag is still needed... but nothing else.
+	struct function_and_flag
+	{
+		Func function;
+		bool flag;
+	};
+
+	BOOST_TEST(sizeof(indi::scope_exit<Func>) == sizeof(function_and_flag));
+}
+
+BOOST_AUTO_TEST_CASE(size_WITH_function_pointer)
+{
+	BOOST_TEST(sizeof(indi::scope_exit<void(*)()>) == sizeof(void(*)()));
+}
+
+BOOST_AUTO_TEST_CASE(size_WITH_function_reference)
+{
+	BOOST_TEST(sizeof(indi::scope_exit<void(&)()>) == sizeof(void(*)()));
+}
+
+/*****************************************************************************
+ * scope_exit_always tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_exit_always_basic_operation_WITH_lvalue_CASE_success,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto func = Func{call_count};
+		auto const _ = indi::scope_exit_always<Func&>{func};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_exit_always_basic_operation_WITH_rvalue_CASE_success,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit_always{Func{call_count}};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_exit_always_basic_operation_WITH_rvalue_CASE_fail,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto const _ = indi::scope_exit_always{Func{call_count}};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_always_exit_function_called_on_init_failure)
+{
+	// See exit_function_called_on_init_failure.
+	class functor_t
+	{
+	public:
+		explicit functor_t(int& counter) : _p_counter{&counter} {}
+		functor_t(functor_t const& other) : _p_counter{other._p_counter} { throw indi_test::exception{}; }
+		functor_t(functor_t&& other) noexcept(false) : _p_counter{other._p_counter} {}
+
+		auto operator()() { ++(*_p_counter); }
+
+	private:
+		int* _p_counter = nullptr;
+	};
+
+	auto call_count = 0;
+
+	BOOST_CHECK_THROW(indi::scope_exit_always{functor_t{call_count}}, indi_test::exception);
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(scope_exit_always_size, Func, indi_test::rvalue_functors<int>)
+{
+	// No flag is needed.
+	BOOST_TEST(sizeof(indi::scope_exit_always<Func>) == sizeof(Func));
+	BOOST_TEST(sizeof(indi::scope_exit_always<Func&>) == sizeof(Func*));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(scope_exit_always_special_operations, Func, indi_test::all_functors<int>)
+{
+	BOOST_TEST(not std::is_default_constructible_v<indi::scope_exit_always<Func&>>);
+	BOOST_TEST(not std::is_copy_constructible_v<indi::scope_exit_always<Func&>>);
+	BOOST_TEST(not std::is_move_constructible_v<indi::scope_exit_always<Func&>>);
+	BOOST_TEST(not std::is_copy_assignable_v<indi::scope_exit_always<Func&>>);
+	BOOST_TEST(not std::is_move_assignable_v<indi::scope_exit_always<Func&>>);
+}
+
+/*****************************************************************************
+ * scope_exit_fn tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(scope_exit_fn_basic_operation_CASE_success)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit_fn<&indi_test::function>{};
+		BOOST_TEST(indi_test::function_call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_fn_basic_operation_CASE_fail)
+{
+	indi_test::function_call_count = 0;
+
+	try
+	{
+		auto const _ = indi::scope_exit_fn<&indi_test::function>{};
+		BOOST_TEST(indi_test::function_call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(indi_test::function_call_count == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_fn_basic_operation_WITH_lambda)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit_fn<[] { indi_test::function(); }>{};
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_fn_release_operation_CASE_success)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit_fn<&indi_test::function>{};
+
+		scope_guard.release();
+		BOOST_TEST(indi_test::function_call_count == 0, "function called by release");
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 0, "function called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_fn_release_operation_CASE_fail)
+{
+	indi_test::function_call_count = 0;
+
+	try
+	{
+		auto scope_guard = indi::scope_exit_fn<&indi_test::function>{};
+
+		scope_guard.release();
+		BOOST_TEST(indi_test::function_call_count == 0, "function called by release");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(indi_test::function_call_count == 0, "function called despite release");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_fn_moving)
+{
+	using scope_exit_ptr = std::unique_ptr<indi::scope_exit_fn<&indi_test::function>>;
+
+	indi_test::function_call_count = 0;
+
+	auto p_scope_guard_1 = scope_exit_ptr{new indi::scope_exit_fn<&indi_test::function>{}};
+
+	auto p_scope_guard_2 = scope_exit_ptr{new indi::scope_exit_fn{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(indi_test::function_call_count == 0, "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(indi_test::function_call_count == 0, "function called by releasing moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_fn_size)
+{
+	// Only the minimal state is stored - not the function.
+	BOOST_TEST(sizeof(indi::scope_exit_fn<&indi_test::function>) == sizeof(bool));
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_fn_special_operations)
+{
+	using guard_t = indi::scope_exit_fn<&indi_test::function>;
+
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_constructible_v<guard_t>);
+}
+
+/*****************************************************************************
+ * scope_exit_ref tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_exit_ref_basic_operation_CASE_success,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto func = Func{call_count};
+		auto const _ = indi::scope_exit_ref{func};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_exit_ref_basic_operation_CASE_fail,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto func = Func{call_count};
+		auto const _ = indi::scope_exit_ref{func};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_ref_basic_operation_WITH_function)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit_ref{indi_test::function};
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_ref_release_operation)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto func = indi_test::functor_t<int>{call_count};
+		auto scope_guard = indi::scope_exit_ref{func};
+
+		scope_guard.release();
+		BOOST_TEST(call_count == 0, "function called by release");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 0, "function called despite release");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_ref_moving)
+{
+	using scope_guard_ptr = std::unique_ptr<indi::scope_exit_ref>;
+
+	auto call_count = 0;
+	auto func = indi_test::functor_t<int>{call_count};
+
+	auto p_scope_guard_1 = scope_guard_ptr{new indi::scope_exit_ref{func}};
+
+	auto p_scope_guard_2 = scope_guard_ptr{new indi::scope_exit_ref{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(call_count == 0, "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(call_count == 0, "function called by releasing moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_ref_size)
+{
+	// Only a pointer to the function and a pointer to the thunk are stored
+	// (plus the minimal state).
+	BOOST_TEST(sizeof(indi::scope_exit_ref) == 2 * sizeof(void*));
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_ref_special_operations)
+{
+	using guard_t = indi::scope_exit_ref;
+
+	BOOST_TEST(not std::is_default_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_destructible_v<guard_t>);
+
+	// The function must outlive the guard, so it can't be a temporary.
+	BOOST_TEST((not std::is_constructible_v<guard_t, indi_test::functor_t<int>>));
+	BOOST_TEST((std::is_constructible_v<guard_t, indi_test::functor_t<int>&>));
+}
+
+/*****************************************************************************
+ * Execute and rearm tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(execute, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit{Func{call_count}};
+
+		scope_guard.execute();
+		BOOST_TEST(call_count == 1);
+
+		scope_guard.execute();
+		BOOST_TEST(call_count == 1, "function called twice by execute");
+	}
+
+	BOOST_TEST(call_count == 1, "function called by destructor after execute");
+}
+
+BOOST_AUTO_TEST_CASE(execute_CASE_released)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit{indi_test::functor_t<int>{call_count}};
+
+		scope_guard.release();
+		scope_guard.execute();
+	}
+
+	BOOST_TEST(call_count == 0, "function called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(execute_WITH_function_pointer)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit{&indi_test::function};
+
+		scope_guard.execute();
+		BOOST_TEST(indi_test::function_call_count == 1);
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+namespace {
+
+// Functor whose call throws.
+struct throwing_call_functor_t : indi_test::functor_base<int>
+{
+	using indi_test::functor_base<int>::functor_base;
+
+	auto operator()() -> void
+	{
+		increment_counter();
+		throw indi_test::exception{};
+	}
+};
+
+} // anonymous namespace
+
+// The guard is released before the function is called, so if it throws,
+// the destructor doesn't call it again.
+BOOST_AUTO_TEST_CASE(execute_CASE_throwing)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit{throwing_call_functor_t{call_count}};
+
+		BOOST_CHECK_THROW(scope_guard.execute(), indi_test::exception);
+		BOOST_TEST(call_count == 1);
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(rearm, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit{Func{call_count}};
+
+		scope_guard.release();
+		scope_guard.rearm();
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+// A guard can be reused in each iteration of a loop.
+BOOST_AUTO_TEST_CASE(rearm_CASE_loop)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit{indi_test::functor_t<int>{call_count}};
+
+		for (auto i = 0; i < 10; ++i)
+		{
+			scope_guard.rearm();
+			scope_guard.execute();
+		}
+
+		BOOST_TEST(call_count == 10);
+	}
+
+	BOOST_TEST(call_count == 10);
+}
+
+namespace {
+
+template <typename Guard>
+concept rearmable = requires (Guard& guard) { guard.rearm(); };
+
+} // anonymous namespace
+
+// When the released state is a null pointer, the function is gone, so the
+// guard can't be re-armed.
+BOOST_AUTO_TEST_CASE(rearm_availability)
+{
+	BOOST_TEST(rearmable<indi::scope_exit<indi_test::functor_t<int>>>);
+	BOOST_TEST(not rearmable<indi::scope_exit<void (*)()>>);
+	BOOST_TEST(not rearmable<indi::scope_exit<indi_test::functor_t<int>&>>);
+
+	BOOST_TEST(rearmable<indi::scope_exit_assignable<indi_test::functor_t<int>>>);
+	BOOST_TEST(not rearmable<indi::scope_exit_assignable<void (*)()>>);
+	BOOST_TEST(not rearmable<indi::scope_exit_assignable<indi_test::functor_t<int>&>>);
+}
+
+namespace {
+
+auto rearm_function_pointer_call_count = 0;
+
+auto rearm_function_pointer_function() -> void
+{
+	++rearm_function_pointer_call_count;
+}
+
+} // anonymous namespace
+
+// `scope_exit{&f}` deduces a function pointer, so it keeps the
+// pointer-sized storage (see the sizeof tests) and can't be re-armed. It
+// can still be executed early. Wrapping the call in a lambda gives a guard
+// that can be re-armed.
+BOOST_AUTO_TEST_CASE(rearm_CASE_function_pointer)
+{
+	rearm_function_pointer_call_count = 0;
+
+	{
+		auto scope_guard = indi::scope_exit{&rearm_function_pointer_function};
+
+		static_assert(std::is_same_v<decltype(scope_guard), indi::scope_exit<void (*)()>>);
+		static_assert(not rearmable<decltype(scope_guard)>);
+
+		scope_guard.execute();
+
+		BOOST_TEST(rearm_function_pointer_call_count == 1);
+	}
+
+	BOOST_TEST(rearm_function_pointer_call_count == 1);
+
+	{
+		auto scope_guard = indi::scope_exit{[] { rearm_function_pointer_function(); }};
+
+		static_assert(rearmable<decltype(scope_guard)>);
+
+		scope_guard.execute();
+		scope_guard.rearm();
+
+		BOOST_TEST(rearm_function_pointer_call_count == 2);
+	}
+
+	BOOST_TEST(rearm_function_pointer_call_count == 3);
+}
+
+// A moved-from guard must not be re-armed, but the guard it was moved to
+// can be.
+BOOST_AUTO_TEST_CASE(rearm_CASE_moved_to)
+{
+	auto call_count = 0;
+
+	{
+		auto scope_guard_1 = indi::scope_exit{indi_test::functor_t<int>{call_count}};
+		auto scope_guard_2 = std::move(scope_guard_1);
+
+		scope_guard_2.release();
+		scope_guard_2.rearm();
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(execute_noexcept, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+	auto scope_guard = indi::scope_exit{Func{call_count}};
+
+	BOOST_TEST(noexcept(scope_guard.execute()) == std::is_nothrow_invocable_v<Func&>);
+	BOOST_TEST(noexcept(scope_guard.rearm()));
+
+	scope_guard.release();
+}
+
+/*****************************************************************************
+ * scope_exit_assignable tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_exit_assignable_basic_operation,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit_assignable{Func{call_count}};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+// Move-assigning ends the assigned-to guard, as if it went out of scope.
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_exit_assignable_move_assignment,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard_1 = indi::scope_exit_assignable{Func{call_count_1}};
+		auto scope_guard_2 = indi::scope_exit_assignable{Func{call_count_2}};
+
+		scope_guard_1 = std::move(scope_guard_2);
+		BOOST_TEST(call_count_1 == 1);
+		BOOST_TEST(call_count_2 == 0, "function called by moving scope guard");
+	}
+
+	BOOST_TEST(call_count_1 == 1);
+	BOOST_TEST(call_count_2 == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_assignable_move_assignment_CASE_released)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard_1 = indi::scope_exit_assignable{indi_test::functor_t<int>{call_count_1}};
+		auto scope_guard_2 = indi::scope_exit_assignable{indi_test::functor_t<int>{call_count_2}};
+
+		scope_guard_1.release();
+		scope_guard_1 = std::move(scope_guard_2);
+		BOOST_TEST(call_count_1 == 0, "function called despite release");
+	}
+
+	BOOST_TEST(call_count_1 == 0);
+	BOOST_TEST(call_count_2 == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_assignable_move_assignment_CASE_self)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit_assignable{indi_test::functor_t<int>{call_count}};
+
+		auto& alias = scope_guard;
+		scope_guard = std::move(alias);
+		BOOST_TEST(call_count == 0, "function called by self-assignment");
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_assignable_swap)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard_1 = indi::scope_exit_assignable{indi_test::functor_t<int>{call_count_1}};
+		auto scope_guard_2 = indi::scope_exit_assignable{indi_test::functor_t<int>{call_count_2}};
+
+		scope_guard_2.release();
+
+		using std::swap;
+		swap(scope_guard_1, scope_guard_2);
+		BOOST_TEST(call_count_1 == 0, "function called by swap");
+		BOOST_TEST(call_count_2 == 0, "function called by swap");
+
+		scope_guard_1.swap(scope_guard_1);
+	}
+
+	// The released state was swapped too.
+	BOOST_TEST(call_count_1 == 1);
+	BOOST_TEST(call_count_2 == 0);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_assignable_in_vector)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto guards = std::vector<indi::scope_exit_assignable<indi_test::functor_t<int>>>{};
+		for (auto i = 0; i < 100; ++i)
+			guards.emplace_back(indi_test::functor_t<int>{call_count});
+		BOOST_TEST(call_count == 0, "function called by reallocation");
+
+		guards.erase(guards.begin() + 50);
+		BOOST_TEST(call_count == 1);
+
+		guards.back().release();
+		guards.pop_back();
+		BOOST_TEST(call_count == 1);
+	}
+
+	BOOST_TEST(call_count == 99);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_assignable_WITH_function_pointer)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard_1 = indi::scope_exit_assignable{&indi_test::function};
+		auto scope_guard_2 = indi::scope_exit_assignable{&indi_test::function};
+
+		scope_guard_1 = std::move(scope_guard_2);
+		BOOST_TEST(indi_test::function_call_count == 1);
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 2);
+}
+
+// A guard whose function is trivially relocatable can be relocated with
+// memcpy (and the original forgotten).
+BOOST_AUTO_TEST_CASE(scope_exit_assignable_trivial_relocation)
+{
+	using guard_t = indi::scope_exit_assignable<void (*)()>;
+	static_assert(indi::is_trivially_relocatable_v<guard_t>);
+
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		alignas(guard_t) unsigned char from[sizeof(guard_t)];
+		alignas(guard_t) unsigned char to[sizeof(guard_t)];
+
+		::new (static_cast<void*>(from)) guard_t{&indi_test::function};
+		std::memcpy(to, from, sizeof(guard_t));
+
+		std::destroy_at(std::launder(reinterpret_cast<guard_t*>(to)));
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+namespace {
+
+// Functor that is not trivially relocatable.
+struct string_functor_t
+{
+	std::string name;
+
+	auto operator()() noexcept {}
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(scope_exit_assignable_is_trivially_relocatable)
+{
+	using fptr = void (*)();
+
+	BOOST_TEST(indi::is_trivially_relocatable_v<indi::scope_exit_assignable<fptr>>);
+	BOOST_TEST(indi::is_trivially_relocatable_v<indi::scope_exit_assignable<void (&)()>>);
+	BOOST_TEST(indi::is_trivially_relocatable_v<indi::scope_exit_assignable<string_functor_t&>>);
+	BOOST_TEST(not indi::is_trivially_relocatable_v<indi::scope_exit_assignable<string_functor_t>>);
+
+	// Opt-in only.
+	BOOST_TEST(not indi::is_trivially_relocatable_v<indi::scope_exit<fptr>>);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(scope_exit_assignable_special_operations, Func, indi_test::rvalue_functors<int>)
+{
+	using guard_t = indi::scope_exit_assignable<Func>;
+
+	BOOST_TEST(not std::is_default_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_constructible_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_swappable_v<guard_t>);
+	BOOST_TEST(std::is_final_v<guard_t>);
+}
+
+/*****************************************************************************
+ * scope_exit_all tests
+ ****************************************************************************/
+
+namespace {
+
+// Function object that records the order it was called in.
+struct order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	auto operator()() const noexcept { p_order->push_back(id); }
+};
+
+// Like order_functor_t, but copying throws (and moving may throw, so it is
+// copied).
+struct throwing_copy_order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	throwing_copy_order_functor_t(std::vector<int>* p, int i) : p_order{p}, id{i} {}
+	throwing_copy_order_functor_t(throwing_copy_order_functor_t const&) { throw indi_test::exception{}; }
+	throwing_copy_order_functor_t(throwing_copy_order_functor_t&& other) noexcept(false)
+		: p_order{other.p_order}, id{other.id} {}
+
+	auto operator()() const noexcept { p_order->push_back(id); }
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(scope_exit_all_basic_operation_CASE_success)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit_all{
+			order_functor_t{&order, 1},
+			order_functor_t{&order, 2},
+			order_functor_t{&order, 3}};
+		BOOST_TEST(order.empty(), "function called before scope exit");
+	}
+
+	BOOST_TEST(order == (std::vector<int>{3, 2, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_all_basic_operation_CASE_fail)
+{
+	auto order = std::vector<int>{};
+
+	try
+	{
+		auto const _ = indi::scope_exit_all{order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(order == (std::vector<int>{2, 1}));
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(scope_exit_all_basic_operation_WITH_rvalue, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit_all{Func{call_count}, Func{call_count}};
+	}
+
+	BOOST_TEST(call_count == 2);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_all_basic_operation_WITH_function_and_reference)
+{
+	indi_test::function_call_count = 0;
+	auto call_count = 0;
+	auto func = indi_test::functor_t<int>{call_count};
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_exit_all<void (&)(), void (*)(), indi_test::functor_t<int>&>{
+			indi_test::function,
+			&indi_test::function,
+			func};
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 2);
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_all_release_operation)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit_all{order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+		scope_guard.release();
+	}
+
+	BOOST_TEST(order.empty(), "function called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_all_execute_and_rearm)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_exit_all{order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+
+		scope_guard.execute();
+		BOOST_TEST(order == (std::vector<int>{2, 1}));
+
+		scope_guard.execute();
+		BOOST_TEST(order == (std::vector<int>{2, 1}), "functions called twice by execute");
+
+		scope_guard.rearm();
+	}
+
+	BOOST_TEST(order == (std::vector<int>{2, 1, 2, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_all_moving)
+{
+	using guard_t = indi::scope_exit_all<order_functor_t, order_functor_t>;
+	using scope_guard_ptr = std::unique_ptr<guard_t>;
+
+	auto order = std::vector<int>{};
+
+	auto p_scope_guard_1 = scope_guard_ptr{new guard_t{order_functor_t{&order, 1}, order_functor_t{&order, 2}}};
+
+	auto p_scope_guard_2 = scope_guard_ptr{new guard_t{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(order.empty(), "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(order.empty(), "function called by releasing moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(order == (std::vector<int>{2, 1}));
+}
+
+// When initializing one of the functions fails, that function argument is
+// called, then the functions that were already initialized (in reverse
+// order), like for a sequence of scope_exit guards.
+BOOST_AUTO_TEST_CASE(scope_exit_all_exit_function_called_on_init_failure)
+{
+	auto order = std::vector<int>{};
+
+	BOOST_CHECK_THROW(
+		(indi::scope_exit_all{
+			order_functor_t{&order, 1},
+			order_functor_t{&order, 2},
+			throwing_copy_order_functor_t{&order, 3},
+			order_functor_t{&order, 4}}),
+		indi_test::exception);
+
+	BOOST_TEST(order == (std::vector<int>{3, 2, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_all_size)
+{
+	auto const empty_1 = [] {};
+	auto const empty_2 = [] {};
+	auto const empty_3 = [] {};
+
+	// Empty function objects take no space.
+	BOOST_TEST(sizeof(indi::scope_exit_all{empty_1, empty_2, empty_3}) == sizeof(bool));
+
+	// The functions share a single flag.
+	BOOST_TEST(sizeof(indi::scope_exit_all<void (*)(), void (*)(), void (*)()>) == 4 * sizeof(void*));
+}
+
+BOOST_AUTO_TEST_CASE(scope_exit_all_special_operations)
+{
+	using guard_t = indi::scope_exit_all<indi_test::functor_t<int>, indi_test::move_only_functor_t<int>>;
+
+	BOOST_TEST(not std::is_default_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_constructible_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_destructible_v<guard_t>);
+}
+
 /*****************************************************************************
  * Special operations
  ****************************************************************************/
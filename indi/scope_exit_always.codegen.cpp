@@ -0,0 +1,118 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Codegen tests for scope_exit_always
+ *
+ * Each `<case>__actual` function must compile to exactly the same
+ * instructions as the matching `<case>__expected` function, which is the
+ * hand-written equivalent without a scope guard. (See
+ * tools/compare-codegen.sh.)
+ *
+ * The work done in the scope is `noexcept`, because the unwinding path of a
+ * scope guard (call the function, then resume unwinding) has no hand-written
+ * equivalent without a catch handler.
+ *
+ * In the simple cases, plain scope_exit compiles to the same code too: the
+ * compiler can see that its armed flag is always set, and drops it. The
+ * `destroy_*` cases destroy a guard whose state the compiler can't see (as
+ * if it had been moved, or passed around by reference), to show that
+ * scope_exit then has to check its flag, while scope_exit_always never does.
+ ****************************************************************************/
+
+#include <memory>
+
+#include <indi/scope.hpp>
+
+// Opaque functions, so that the calls can't be optimized away.
+auto work() noexcept -> void;
+auto cleanup() noexcept -> void;
+auto release(int&) noexcept -> void;
+
+extern "C" auto function_pointer__actual() -> void
+{
+	auto const _ = indi::scope_exit_always{&cleanup};
+	work();
+}
+
+extern "C" auto function_pointer__expected() -> void
+{
+	work();
+	cleanup();
+}
+
+extern "C" auto function_reference__actual() -> void
+{
+	auto const _ = indi::scope_exit_always<void(&)()>{cleanup};
+	work();
+}
+
+extern "C" auto function_reference__expected() -> void
+{
+	work();
+	cleanup();
+}
+
+extern "C" auto lambda__actual(int& resource) -> void
+{
+	auto const _ = indi::scope_exit_always{[&resource] { release(resource); }};
+	work();
+}
+
+extern "C" auto lambda__expected(int& resource) -> void
+{
+	work();
+	release(resource);
+}
+
+// Function object that releases a resource.
+struct release_t
+{
+	int* p_resource;
+
+	auto operator()() const noexcept -> void { release(*p_resource); }
+};
+
+// Hand-written equivalent of a release_t with an armed flag.
+struct armed_release_t
+{
+	release_t function;
+	bool armed;
+};
+
+extern "C" auto destroy_scope_exit_always__actual(indi::scope_exit_always<release_t>& guard) -> void
+{
+	std::destroy_at(&guard);
+}
+
+extern "C" auto destroy_scope_exit_always__expected(release_t& f) -> void
+{
+	f();
+}
+
+extern "C" auto destroy_scope_exit__actual(indi::scope_exit<release_t>& guard) -> void
+{
+	std::destroy_at(&guard);
+}
+
+extern "C" auto destroy_scope_exit__expected(armed_release_t& f) -> void
+{
+	if (f.armed)
+		f.function();
+}
@@ -24,6 +24,9 @@
 #	include <boost/test/included/unit_test.hpp>
 #endif // BOOST_TEST_DYN_LINK
 
+#include <memory>
+#include <vector>
+
 #include <indi/scope.hpp>
 
 #include <indi/scope.test.hpp>
@@ -478,6 +481,816 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(
 	}
 }
 
+/*****************************************************************************
+ * Checkpoint tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	checkpoint_WITH_rvalue_CASE_success,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const checkpoint = indi::scope_checkpoint{};
+
+		auto const _1 = indi::scope_fail{checkpoint, Func{call_count}};
+		auto const _2 = indi::scope_fail{checkpoint, Func{call_count}};
+		auto const _3 = indi::scope_fail{checkpoint, Func{call_count}};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	checkpoint_WITH_lvalue_CASE_fail,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto const checkpoint = indi::scope_checkpoint{};
+
+		auto func = Func{call_count};
+		auto const _1 = indi::scope_fail<Func&>{checkpoint, func};
+		auto const _2 = indi::scope_fail<Func&>{checkpoint, func};
+		auto const _3 = indi::scope_fail<Func&>{checkpoint, func};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 3);
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	checkpoint_WITH_rvalue_CASE_fail,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto const checkpoint = indi::scope_checkpoint{};
+
+		auto const _1 = indi::scope_fail{checkpoint, Func{call_count}};
+		auto const _2 = indi::scope_fail{checkpoint, Func{call_count}};
+		auto const _3 = indi::scope_fail{checkpoint, Func{call_count}};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 3);
+	}
+}
+
+// A checkpoint taken during stack unwinding (in a destructor) should only
+// count exceptions thrown after it was taken.
+BOOST_AUTO_TEST_CASE(checkpoint_created_during_unwinding)
+{
+	auto call_count = 0;
+
+	struct unwinder
+	{
+		int& call_count;
+
+		~unwinder()
+		{
+			auto const checkpoint = indi::scope_checkpoint{};
+			BOOST_TEST(checkpoint.uncaught_on_creation() == 1);
+			BOOST_TEST(not checkpoint.unwinding());
+
+			auto const _ = indi::scope_fail{checkpoint, indi_test::functor_t<int>{call_count}};
+		}
+	};
+
+	try
+	{
+		auto const _ = unwinder{call_count};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 0);
+	}
+}
+
+/*****************************************************************************
+ * scope_fail_fn tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(scope_fail_fn_basic_operation_CASE_success)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_fail_fn<&indi_test::function>{};
+		BOOST_TEST(indi_test::function_call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_fn_basic_operation_CASE_fail)
+{
+	indi_test::function_call_count = 0;
+
+	try
+	{
+		auto const _ = indi::scope_fail_fn<&indi_test::function>{};
+		BOOST_TEST(indi_test::function_call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(indi_test::function_call_count == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_fn_basic_operation_WITH_lambda)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_fail_fn<[] { indi_test::function(); }>{};
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_fn_release_operation_CASE_success)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_fail_fn<&indi_test::function>{};
+
+		scope_guard.release();
+		BOOST_TEST(indi_test::function_call_count == 0, "function called by release");
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 0, "function called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_fn_release_operation_CASE_fail)
+{
+	indi_test::function_call_count = 0;
+
+	try
+	{
+		auto scope_guard = indi::scope_fail_fn<&indi_test::function>{};
+
+		scope_guard.release();
+		BOOST_TEST(indi_test::function_call_count == 0, "function called by release");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(indi_test::function_call_count == 0, "function called despite release");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_fn_moving)
+{
+	using scope_fail_ptr = std::unique_ptr<indi::scope_fail_fn<&indi_test::function>>;
+
+	indi_test::function_call_count = 0;
+
+	auto p_scope_guard_1 = scope_fail_ptr{new indi::scope_fail_fn<&indi_test::function>{}};
+
+	auto p_scope_guard_2 = scope_fail_ptr{new indi::scope_fail_fn{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(indi_test::function_call_count == 0, "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(indi_test::function_call_count == 0, "function called by releasing moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(indi_test::function_call_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_fn_size)
+{
+	// Only the minimal state is stored - not the function.
+	BOOST_TEST(sizeof(indi::scope_fail_fn<&indi_test::function>) == sizeof(int));
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_fn_special_operations)
+{
+	using guard_t = indi::scope_fail_fn<&indi_test::function>;
+
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_constructible_v<guard_t>);
+}
+
+/*****************************************************************************
+ * scope_fail_ref tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_fail_ref_basic_operation_CASE_success,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto func = Func{call_count};
+		auto const _ = indi::scope_fail_ref{func};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_fail_ref_basic_operation_CASE_fail,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto func = Func{call_count};
+		auto const _ = indi::scope_fail_ref{func};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_ref_basic_operation_WITH_function)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_fail_ref{indi_test::function};
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_ref_release_operation)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto func = indi_test::functor_t<int>{call_count};
+		auto scope_guard = indi::scope_fail_ref{func};
+
+		scope_guard.release();
+		BOOST_TEST(call_count == 0, "function called by release");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 0, "function called despite release");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_ref_moving)
+{
+	using scope_guard_ptr = std::unique_ptr<indi::scope_fail_ref>;
+
+	auto call_count = 0;
+	auto func = indi_test::functor_t<int>{call_count};
+
+	auto p_scope_guard_1 = scope_guard_ptr{new indi::scope_fail_ref{func}};
+
+	auto p_scope_guard_2 = scope_guard_ptr{new indi::scope_fail_ref{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(call_count == 0, "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(call_count == 0, "function called by releasing moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(call_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_ref_size)
+{
+	// Only a pointer to the function and a pointer to the thunk are stored
+	// (plus the minimal state).
+	BOOST_TEST(sizeof(indi::scope_fail_ref) == 3 * sizeof(void*));
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_ref_special_operations)
+{
+	using guard_t = indi::scope_fail_ref;
+
+	BOOST_TEST(not std::is_default_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_destructible_v<guard_t>);
+
+	// The function must outlive the guard, so it can't be a temporary.
+	BOOST_TEST((not std::is_constructible_v<guard_t, indi_test::functor_t<int>>));
+	BOOST_TEST((std::is_constructible_v<guard_t, indi_test::functor_t<int>&>));
+}
+
+/*****************************************************************************
+ * Execute and rearm tests
+ ****************************************************************************/
+
+// Outside of stack unwinding, execute() doesn't call the function, but
+// still releases the guard.
+BOOST_AUTO_TEST_CASE_TEMPLATE(execute_CASE_success, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto scope_guard = indi::scope_fail{Func{call_count}};
+
+		scope_guard.execute();
+		BOOST_TEST(call_count == 0, "function called on success");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 0, "function called after execute");
+	}
+}
+
+// During stack unwinding, execute() calls the function, and the destructor
+// doesn't call it again.
+BOOST_AUTO_TEST_CASE(execute_CASE_fail)
+{
+	using guard_t = indi::scope_fail<indi_test::functor_t<int>>;
+
+	auto call_count = 0;
+
+	struct executor
+	{
+		guard_t& guard;
+		int& call_count;
+
+		~executor()
+		{
+			guard.execute();
+			BOOST_TEST(call_count == 1);
+		}
+	};
+
+	try
+	{
+		auto scope_guard = guard_t{indi_test::functor_t<int>{call_count}};
+		auto const _ = executor{scope_guard, call_count};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(rearm, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto scope_guard = indi::scope_fail{Func{call_count}};
+
+		scope_guard.release();
+		scope_guard.rearm();
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+namespace {
+
+auto rearm_function_pointer_call_count = 0;
+
+auto rearm_function_pointer_function() -> void
+{
+	++rearm_function_pointer_call_count;
+}
+
+} // anonymous namespace
+
+// Unlike scope_exit, the released state is stored in the uncaught exception
+// count, so a guard holding a function pointer can be re-armed too.
+BOOST_AUTO_TEST_CASE(rearm_CASE_function_pointer)
+{
+	rearm_function_pointer_call_count = 0;
+
+	try
+	{
+		auto scope_guard = indi::scope_fail{&rearm_function_pointer_function};
+
+		scope_guard.release();
+		scope_guard.rearm();
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(rearm_function_pointer_call_count == 1);
+	}
+}
+
+// A guard can be reused in each iteration of a loop.
+BOOST_AUTO_TEST_CASE(rearm_CASE_loop)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto scope_guard = indi::scope_fail{indi_test::functor_t<int>{call_count}};
+
+		for (auto i = 0; i < 10; ++i)
+		{
+			scope_guard.rearm();
+			// [...]
+			scope_guard.release();
+		}
+
+		scope_guard.rearm();
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+// Re-arming takes the current number of uncaught exceptions, like creating
+// a guard, so a guard re-armed during stack unwinding only fails on a new
+// exception.
+BOOST_AUTO_TEST_CASE(rearm_CASE_during_unwinding)
+{
+	using guard_t = indi::scope_fail<indi_test::functor_t<int>>;
+
+	auto call_count = 0;
+
+	struct rearmer
+	{
+		guard_t& guard;
+
+		~rearmer() { guard.rearm(); }
+	};
+
+	// Artificial scope
+	{
+		auto scope_guard = guard_t{indi_test::functor_t<int>{call_count}};
+
+		try
+		{
+			auto const _ = rearmer{scope_guard};
+			throw indi_test::exception{};
+		}
+		catch (indi_test::exception const&)
+		{
+		}
+	}
+
+	BOOST_TEST(call_count == 0);
+}
+
+/*****************************************************************************
+ * scope_fail_assignable tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_fail_assignable_basic_operation,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_fail_assignable{Func{call_count}};
+	}
+
+	BOOST_TEST(call_count == 0, "function called on success");
+
+	try
+	{
+		auto const _ = indi::scope_fail_assignable{Func{call_count}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+// Move-assigning ends the assigned-to guard as if it went out of scope, so
+// outside of stack unwinding, its function isn't called. The assigned-from
+// guard's function (and uncaught exception count) carry on.
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_fail_assignable_move_assignment,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	try
+	{
+		auto scope_guard_1 = indi::scope_fail_assignable{Func{call_count_1}};
+		auto scope_guard_2 = indi::scope_fail_assignable{Func{call_count_2}};
+
+		scope_guard_1 = std::move(scope_guard_2);
+		BOOST_TEST(call_count_1 == 0, "function called on success");
+		BOOST_TEST(call_count_2 == 0, "function called by moving scope guard");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count_1 == 0);
+		BOOST_TEST(call_count_2 == 1);
+	}
+}
+
+// During stack unwinding, the assigned-to guard's function is called.
+BOOST_AUTO_TEST_CASE(scope_fail_assignable_move_assignment_CASE_unwinding)
+{
+	using guard_t = indi::scope_fail_assignable<indi_test::functor_t<int>>;
+
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	struct assigner
+	{
+		guard_t& guard_1;
+		guard_t& guard_2;
+
+		~assigner() { guard_1 = std::move(guard_2); }
+	};
+
+	// Artificial scope
+	{
+		auto scope_guard_1 = guard_t{indi_test::functor_t<int>{call_count_1}};
+
+		try
+		{
+			auto scope_guard_2 = guard_t{indi_test::functor_t<int>{call_count_2}};
+			auto const _ = assigner{scope_guard_1, scope_guard_2};
+
+			throw indi_test::exception{};
+		}
+		catch (indi_test::exception const&)
+		{
+			BOOST_TEST(call_count_1 == 1);
+			BOOST_TEST(call_count_2 == 0);
+		}
+	}
+
+	// scope_guard_2 was created outside of stack unwinding, so its function
+	// is not called when it (now in scope_guard_1) is destroyed normally.
+	BOOST_TEST(call_count_2 == 0);
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_assignable_swap)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	try
+	{
+		auto scope_guard_1 = indi::scope_fail_assignable{indi_test::functor_t<int>{call_count_1}};
+		auto scope_guard_2 = indi::scope_fail_assignable{indi_test::functor_t<int>{call_count_2}};
+
+		scope_guard_2.release();
+		swap(scope_guard_1, scope_guard_2);
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count_1 == 1);
+		BOOST_TEST(call_count_2 == 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_assignable_is_trivially_relocatable)
+{
+	BOOST_TEST(indi::is_trivially_relocatable_v<indi::scope_fail_assignable<void (*)()>>);
+	BOOST_TEST(not indi::is_trivially_relocatable_v<indi::scope_fail<void (*)()>>);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(scope_fail_assignable_special_operations, Func, indi_test::rvalue_functors<int>)
+{
+	using guard_t = indi::scope_fail_assignable<Func>;
+
+	BOOST_TEST(not std::is_default_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_constructible_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_swappable_v<guard_t>);
+	BOOST_TEST(std::is_final_v<guard_t>);
+}
+
+/*****************************************************************************
+ * scope_fail_all tests
+ ****************************************************************************/
+
+namespace {
+
+// Function object that records the order it was called in.
+struct order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	auto operator()() const noexcept { p_order->push_back(id); }
+};
+
+// Like order_functor_t, but copying throws (and moving may throw, so it is
+// copied).
+struct throwing_copy_order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	throwing_copy_order_functor_t(std::vector<int>* p, int i) : p_order{p}, id{i} {}
+	throwing_copy_order_functor_t(throwing_copy_order_functor_t const&) { throw indi_test::exception{}; }
+	throwing_copy_order_functor_t(throwing_copy_order_functor_t&& other) noexcept(false)
+		: p_order{other.p_order}, id{other.id} {}
+
+	auto operator()() const noexcept { p_order->push_back(id); }
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(scope_fail_all_basic_operation_CASE_success)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_fail_all{order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+	}
+
+	BOOST_TEST(order.empty(), "function called on success");
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_all_basic_operation_CASE_fail)
+{
+	auto order = std::vector<int>{};
+
+	try
+	{
+		auto const _ = indi::scope_fail_all{
+			order_functor_t{&order, 1},
+			order_functor_t{&order, 2},
+			order_functor_t{&order, 3}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(order == (std::vector<int>{3, 2, 1}));
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(scope_fail_all_basic_operation_WITH_rvalue, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto const _ = indi::scope_fail_all{Func{call_count}, Func{call_count}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 2);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_all_release_operation)
+{
+	auto order = std::vector<int>{};
+
+	try
+	{
+		auto scope_guard = indi::scope_fail_all{order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+		scope_guard.release();
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(order.empty(), "function called despite release");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_all_WITH_checkpoint)
+{
+	auto order = std::vector<int>{};
+
+	try
+	{
+		auto const checkpoint = indi::scope_checkpoint{};
+		auto const _ = indi::scope_fail_all{checkpoint, order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(order == (std::vector<int>{2, 1}));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_all_moving)
+{
+	using guard_t = indi::scope_fail_all<order_functor_t, order_functor_t>;
+
+	auto order = std::vector<int>{};
+
+	try
+	{
+		auto scope_guard_1 = guard_t{order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+		auto const scope_guard_2 = guard_t{std::move(scope_guard_1)};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(order == (std::vector<int>{2, 1}));
+	}
+}
+
+// When initializing one of the functions fails, that function argument is
+// called, then the functions that were already initialized (in reverse
+// order), like for a sequence of scope_fail guards.
+BOOST_AUTO_TEST_CASE(scope_fail_all_exit_function_called_on_init_failure)
+{
+	auto order = std::vector<int>{};
+
+	BOOST_CHECK_THROW(
+		(indi::scope_fail_all{
+			order_functor_t{&order, 1},
+			throwing_copy_order_functor_t{&order, 2},
+			order_functor_t{&order, 3}}),
+		indi_test::exception);
+
+	BOOST_TEST(order == (std::vector<int>{2, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_all_size)
+{
+	auto const empty_1 = [] {};
+	auto const empty_2 = [] {};
+
+	// Only the uncaught exception count, shared by all the functions.
+	BOOST_TEST(sizeof(indi::scope_fail_all{empty_1, empty_2}) == sizeof(int));
+}
+
+BOOST_AUTO_TEST_CASE(scope_fail_all_special_operations)
+{
+	using guard_t = indi::scope_fail_all<indi_test::functor_t<int>, indi_test::move_only_functor_t<int>>;
+
+	BOOST_TEST(not std::is_default_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_constructible_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_destructible_v<guard_t>);
+}
+
 /*****************************************************************************
  * Special operations
  ****************************************************************************/
@@ -0,0 +1,366 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+// Compares every scope guard, with every kind of test function object,
+// against the equivalent hand-written try/catch cleanup.
+//
+// For each combination, four operations are measured:
+//  *   construct+destroy : the guard is created, and the scope is exited
+//                          normally.
+//  *   release :           the guard is created, then released.
+//  *   move :              the guard is created, then moved into a second
+//                          guard. (There is no hand-written equivalent of a
+//                          move, so the baseline is the same as for
+//                          construct+destroy.)
+//  *   unwind :            the guard is created, and the scope is exited
+//                          via an exception.
+
+#include <functional>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.bench.hpp>
+#include <indi/scope.test.hpp>
+
+namespace {
+
+int counter = 0;
+
+// Set to true to make maybe_throw() throw. Never actually set, but the
+// compiler can't know that.
+volatile bool should_throw = false;
+
+[[gnu::noinline]] auto maybe_throw() -> void
+{
+	if (should_throw)
+		throw indi_test::exception{};
+}
+
+[[gnu::noinline]] auto always_throw() -> void
+{
+	throw indi_test::exception{};
+}
+
+/*****************************************************************************
+ * Benchmarked operations.
+ ****************************************************************************/
+
+using benchmark_function = auto (*)() -> void;
+
+struct benchmark_set
+{
+	benchmark_function construct_destroy = nullptr;
+	benchmark_function release = nullptr;
+	benchmark_function move = nullptr;
+	benchmark_function unwind = nullptr;
+};
+
+// When the cleanup function is called.
+enum class fires { always, on_success, on_failure };
+
+// Hand-written equivalents, using try/catch.
+template <fires When, typename Func>
+struct hand_written
+{
+	[[gnu::noinline]] static auto construct_destroy() -> void
+	{
+		auto f = Func{counter};
+
+		if constexpr (When == fires::on_success)
+		{
+			maybe_throw();
+		}
+		else
+		{
+			try
+			{
+				maybe_throw();
+			}
+			catch (...)
+			{
+				f();
+				throw;
+			}
+		}
+
+		if constexpr (When != fires::on_failure)
+			f();
+	}
+
+	// Released after maybe_throw(), so the cleanup is only needed if it
+	// throws.
+	[[gnu::noinline]] static auto release() -> void
+	{
+		auto f = Func{counter};
+
+		if constexpr (When == fires::on_success)
+		{
+			maybe_throw();
+		}
+		else
+		{
+			try
+			{
+				maybe_throw();
+			}
+			catch (...)
+			{
+				f();
+				throw;
+			}
+		}
+	}
+
+	[[gnu::noinline]] static auto unwind() -> void
+	{
+		try
+		{
+			auto f = Func{counter};
+
+			if constexpr (When == fires::on_success)
+			{
+				always_throw();
+			}
+			else
+			{
+				try
+				{
+					always_throw();
+				}
+				catch (...)
+				{
+					f();
+					throw;
+				}
+			}
+		}
+		catch (indi_test::exception const&)
+		{}
+	}
+
+	static constexpr auto set = benchmark_set{
+		construct_destroy,
+		release,
+		construct_destroy,
+		unwind};
+};
+
+// The same operations, using a scope guard.
+template <template <typename> class Guard, typename Func>
+struct guarded
+{
+	[[gnu::noinline]] static auto construct_destroy() -> void
+	{
+		auto const _ = Guard<Func>{Func{counter}};
+		maybe_throw();
+	}
+
+	[[gnu::noinline]] static auto release() -> void
+	{
+		auto guard = Guard<Func>{Func{counter}};
+		maybe_throw();
+		guard.release();
+	}
+
+	[[gnu::noinline]] static auto move() -> void
+	{
+		auto guard = Guard<Func>{Func{counter}};
+		auto const _ = Guard<Func>{std::move(guard)};
+		maybe_throw();
+	}
+
+	[[gnu::noinline]] static auto unwind() -> void
+	{
+		try
+		{
+			auto const _ = Guard<Func>{Func{counter}};
+			always_throw();
+		}
+		catch (indi_test::exception const&)
+		{}
+	}
+
+	static constexpr auto set = benchmark_set{
+		construct_destroy,
+		release,
+		move,
+		unwind};
+
+	// For guards that can't be released or moved.
+	static constexpr auto immovable_set = benchmark_set{
+		construct_destroy,
+		nullptr,
+		nullptr,
+		unwind};
+};
+
+// The same operations, using a scope guard with the function as a template
+// argument.
+template <template <auto> class Guard>
+struct guarded_fn
+{
+	[[gnu::noinline]] static auto construct_destroy() -> void
+	{
+		auto const _ = Guard<&indi_test::function>{};
+		maybe_throw();
+	}
+
+	[[gnu::noinline]] static auto release() -> void
+	{
+		auto guard = Guard<&indi_test::function>{};
+		maybe_throw();
+		guard.release();
+	}
+
+	[[gnu::noinline]] static auto move() -> void
+	{
+		auto guard = Guard<&indi_test::function>{};
+		auto const _ = Guard<&indi_test::function>{std::move(guard)};
+		maybe_throw();
+	}
+
+	[[gnu::noinline]] static auto unwind() -> void
+	{
+		try
+		{
+			auto const _ = Guard<&indi_test::function>{};
+			always_throw();
+		}
+		catch (indi_test::exception const&)
+		{}
+	}
+
+	static constexpr auto set = benchmark_set{
+		construct_destroy,
+		release,
+		move,
+		unwind};
+};
+
+// Function object that calls indi_test::function() directly, used as the
+// hand-written equivalent of the *_fn scope guards.
+struct direct_call_t
+{
+	explicit direct_call_t(int&) noexcept {}
+
+	auto operator()() -> void { indi_test::function(); }
+};
+
+// Function object that takes the outcome, for scope_outcome.
+struct outcome_functor_t : indi_test::functor_base<int>
+{
+	using indi_test::functor_base<int>::functor_base;
+
+	auto operator()(indi::outcome) { increment_counter(); }
+};
+
+// Type-erased guards (the function type is ignored), to compare
+// any_scope_exit with the std::function alternative.
+template <typename Func>
+using any_scope_exit_t = indi::any_scope_exit<>;
+
+template <typename Func>
+using std_function_scope_exit_t = indi::scope_exit<std::function<void()>>;
+
+/*****************************************************************************
+ * Running and reporting.
+ ****************************************************************************/
+
+template <typename Func> constexpr char const* functor_name = "";
+template <> constexpr char const* functor_name<indi_test::functor_t<int>> = "functor_t";
+template <> constexpr char const* functor_name<indi_test::const_functor_t<int>> = "const_functor_t";
+template <> constexpr char const* functor_name<indi_test::noexcept_functor_t<int>> = "noexcept_functor_t";
+template <> constexpr char const* functor_name<indi_test::const_noexcept_functor_t<int>> = "const_noexcept_functor_t";
+template <> constexpr char const* functor_name<indi_test::move_only_functor_t<int>> = "move_only_functor_t";
+template <> constexpr char const* functor_name<indi_test::copy_only_functor_t<int>> = "copy_only_functor_t";
+template <> constexpr char const* functor_name<indi_test::move_throws_functor_t<int>> = "move_throws_functor_t";
+
+auto run(std::string const& name, benchmark_set const& guard, benchmark_set const& baseline) -> void
+{
+	auto const row = [&name](char const* operation, benchmark_function g, benchmark_function b)
+	{
+		if (g != nullptr)
+			indi_bench::report((name + " " + operation).c_str(), indi_bench::measure(g), indi_bench::measure(b));
+	};
+
+	row("construct+destroy", guard.construct_destroy, baseline.construct_destroy);
+	row("release", guard.release, baseline.release);
+	row("move", guard.move, baseline.move);
+	row("unwind", guard.unwind, baseline.unwind);
+}
+
+// Runs the benchmarks for a guard, with every kind of rvalue functor.
+template <template <typename> class Guard, fires When, bool Movable = true>
+auto run_all_functors(char const* guard_name) -> void
+{
+	[guard_name]<typename... Funcs>(std::tuple<Funcs...>*)
+	{
+		auto const guard_set = []<typename Func>(Func*)
+		{
+			if constexpr (Movable)
+				return guarded<Guard, Func>::set;
+			else
+				return guarded<Guard, Func>::immovable_set;
+		};
+
+		(run(std::string{guard_name} + "<" + functor_name<Funcs> + ">",
+			guard_set(static_cast<Funcs*>(nullptr)),
+			hand_written<When, Funcs>::set), ...);
+	}(static_cast<indi_test::rvalue_functors<int>*>(nullptr));
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+	run_all_functors<indi::scope_exit, fires::always>("scope_exit");
+	run_all_functors<indi::scope_success, fires::on_success>("scope_success");
+	run_all_functors<indi::scope_fail, fires::on_failure>("scope_fail");
+	run_all_functors<indi::scope_exit_always, fires::always, false>("scope_exit_always");
+
+	run("scope_outcome<outcome_functor_t>",
+		guarded<indi::scope_outcome, outcome_functor_t>::set,
+		hand_written<fires::always, indi_test::functor_t<int>>::set);
+
+	run("scope_exit_fn<&function>",
+		guarded_fn<indi::scope_exit_fn>::set,
+		hand_written<fires::always, direct_call_t>::set);
+	run("scope_success_fn<&function>",
+		guarded_fn<indi::scope_success_fn>::set,
+		hand_written<fires::on_success, direct_call_t>::set);
+	run("scope_fail_fn<&function>",
+		guarded_fn<indi::scope_fail_fn>::set,
+		hand_written<fires::on_failure, direct_call_t>::set);
+
+	run("any_scope_exit<>(functor_t)",
+		guarded<any_scope_exit_t, indi_test::functor_t<int>>::set,
+		hand_written<fires::always, indi_test::functor_t<int>>::set);
+	run("any_scope_exit<>(move_only_functor_t)",
+		guarded<any_scope_exit_t, indi_test::move_only_functor_t<int>>::set,
+		hand_written<fires::always, indi_test::move_only_functor_t<int>>::set);
+	run("scope_exit<std::function<void()>>(functor_t)",
+		guarded<std_function_scope_exit_t, indi_test::functor_t<int>>::set,
+		hand_written<fires::always, indi_test::functor_t<int>>::set);
+
+	indi_bench::do_not_optimize(counter);
+	indi_bench::do_not_optimize(indi_test::function_call_count);
+}
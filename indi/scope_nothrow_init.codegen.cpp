@@ -0,0 +1,220 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Codegen tests for scope guard construction
+ *
+ * When initializing the exit function can't throw, constructing a scope
+ * guard must not generate any exception handling code or metadata (no
+ * landing pad for the function-try-block that calls the exit function on
+ * initialization failure, and so no `.gcc_except_table` entry). Each
+ * `<case>__no_eh` function is checked for that, and each `<case>__has_eh`
+ * function (where initialization can throw) is checked for the opposite.
+ * (See tools/compare-codegen.sh.)
+ *
+ * Usually, the compiler can see that a handler around initialization that
+ * can't throw is dead, and removes it anyway. So this module is compiled
+ * with `-fnon-call-exceptions` (any instruction that may trap may throw),
+ * and without optimization, and a trivially copyable function object is
+ * used: copying it is a plain memory access, which the handler would have
+ * to cover. Without inlining, the checks follow the calls into the
+ * constructor instantiations.
+ *
+ * When initialization can't throw, the guard is constructed into storage
+ * provided by the caller (and never destroyed). So the constructor must
+ * also be `noexcept`, or the caller needs a cleanup to free the storage.
+ * When initialization can throw, the guard is a local variable instead, so
+ * the only landing pad can be in the constructor itself.
+ ****************************************************************************/
+
+#include <new>
+#include <system_error>
+
+#include <indi/scope.hpp>
+
+// Opaque function objects (declared only), so that nothing about them can be
+// optimized.
+
+// Function object with a `noexcept` copy constructor (but no move
+// constructor, so it is always copied).
+struct nothrow_copy_t
+{
+	nothrow_copy_t(nothrow_copy_t const&) noexcept;
+
+	auto operator()() const noexcept -> void;
+	auto operator()(indi::outcome) const noexcept -> void;
+};
+
+// Trivially copyable function object (so copying it is inline).
+struct trivial_copy_t
+{
+	int* p_state;
+
+	auto operator()() const noexcept -> void;
+	auto operator()(indi::outcome) const noexcept -> void;
+};
+
+// Function object with a copy constructor that may throw.
+struct throwing_copy_t
+{
+	throwing_copy_t(throwing_copy_t const&);
+
+	auto operator()() const noexcept -> void;
+	auto operator()(indi::outcome) const noexcept -> void;
+};
+
+/*****************************************************************************
+ * scope_exit
+ ****************************************************************************/
+
+extern "C" auto scope_exit_function_pointer__no_eh(void* storage, void (*f)()) -> void
+{
+	::new (storage) indi::scope_exit<void (*)()>{f};
+}
+
+extern "C" auto scope_exit_nothrow_copy__no_eh(void* storage, nothrow_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_exit<nothrow_copy_t>{f};
+}
+
+extern "C" auto scope_exit_trivial_copy__no_eh(void* storage, trivial_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_exit<trivial_copy_t>{f};
+}
+
+extern "C" auto scope_exit_throwing_copy__has_eh(throwing_copy_t const& f) -> void
+{
+	[[maybe_unused]] auto const guard = indi::scope_exit<throwing_copy_t>{f};
+}
+
+/*****************************************************************************
+ * scope_exit_always
+ ****************************************************************************/
+
+extern "C" auto scope_exit_always_nothrow_copy__no_eh(void* storage, nothrow_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_exit_always<nothrow_copy_t>{f};
+}
+
+extern "C" auto scope_exit_always_trivial_copy__no_eh(void* storage, trivial_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_exit_always<trivial_copy_t>{f};
+}
+
+extern "C" auto scope_exit_always_throwing_copy__has_eh(throwing_copy_t const& f) -> void
+{
+	[[maybe_unused]] auto const guard = indi::scope_exit_always<throwing_copy_t>{f};
+}
+
+/*****************************************************************************
+ * scope_fail
+ ****************************************************************************/
+
+extern "C" auto scope_fail_nothrow_copy__no_eh(void* storage, nothrow_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_fail<nothrow_copy_t>{f};
+}
+
+extern "C" auto scope_fail_checkpoint_nothrow_copy__no_eh(
+	void* storage,
+	indi::scope_checkpoint const& checkpoint,
+	nothrow_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_fail<nothrow_copy_t>{checkpoint, f};
+}
+
+extern "C" auto scope_fail_trivial_copy__no_eh(void* storage, trivial_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_fail<trivial_copy_t>{f};
+}
+
+extern "C" auto scope_fail_throwing_copy__has_eh(throwing_copy_t const& f) -> void
+{
+	[[maybe_unused]] auto const guard = indi::scope_fail<throwing_copy_t>{f};
+}
+
+/*****************************************************************************
+ * scope_success
+ *
+ * scope_success never calls the exit function on initialization failure,
+ * so it never needs exception handling code, even if initialization can
+ * throw.
+ ****************************************************************************/
+
+extern "C" auto scope_success_nothrow_copy__no_eh(void* storage, nothrow_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_success<nothrow_copy_t>{f};
+}
+
+extern "C" auto scope_success_trivial_copy__no_eh(void* storage, trivial_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_success<trivial_copy_t>{f};
+}
+
+extern "C" auto scope_success_throwing_copy__no_eh(throwing_copy_t const& f) -> void
+{
+	[[maybe_unused]] auto const guard = indi::scope_success<throwing_copy_t>{f};
+}
+
+/*****************************************************************************
+ * scope_outcome
+ ****************************************************************************/
+
+extern "C" auto scope_outcome_nothrow_copy__no_eh(void* storage, nothrow_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_outcome<nothrow_copy_t>{f};
+}
+
+extern "C" auto scope_outcome_trivial_copy__no_eh(void* storage, trivial_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_outcome<trivial_copy_t>{f};
+}
+
+extern "C" auto scope_outcome_throwing_copy__has_eh(throwing_copy_t const& f) -> void
+{
+	[[maybe_unused]] auto const guard = indi::scope_outcome<throwing_copy_t>{f};
+}
+
+/*****************************************************************************
+ * scope_fail_if and scope_success_if
+ *
+ * Like scope_fail and scope_success, except the failure signal is an
+ * explicit status object (or flag), so no uncaught exception count is
+ * queried either.
+ ****************************************************************************/
+
+extern "C" auto scope_fail_if_nothrow_copy__no_eh(void* storage, std::error_code const& ec, nothrow_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_fail_if<nothrow_copy_t, std::error_code>{ec, f};
+}
+
+extern "C" auto scope_fail_if_trivial_copy__no_eh(void* storage, std::error_code const& ec, trivial_copy_t const& f) -> void
+{
+	::new (storage) indi::scope_fail_if<trivial_copy_t, std::error_code>{ec, f};
+}
+
+extern "C" auto scope_fail_if_throwing_copy__has_eh(std::error_code const& ec, throwing_copy_t const& f) -> void
+{
+	[[maybe_unused]] auto const guard = indi::scope_fail_if<throwing_copy_t, std::error_code>{ec, f};
+}
+
+extern "C" auto scope_success_if_throwing_copy__no_eh(throwing_copy_t const& f) -> void
+{
+	[[maybe_unused]] auto const guard = indi::scope_success_if<throwing_copy_t>{f};
+}
@@ -0,0 +1,439 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#define BOOST_TEST_MODULE scope_outcome
+#ifdef BOOST_TEST_DYN_LINK
+#	include <boost/test/unit_test.hpp>
+#else
+#	include <boost/test/included/unit_test.hpp>
+#endif // BOOST_TEST_DYN_LINK
+
+#include <memory>
+#include <tuple>
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.test.hpp>
+
+/*****************************************************************************
+ * Test function objects.
+ *
+ * Like the test function objects in scope.test.hpp, except that they take
+ * the outcome, and count successes and failures separately.
+ ****************************************************************************/
+
+namespace {
+
+class outcome_functor_base
+{
+public:
+	explicit outcome_functor_base(int& success_count, int& failure_count) noexcept :
+		_p_success_count{&success_count},
+		_p_failure_count{&failure_count}
+	{}
+
+	auto count(indi::outcome o) const noexcept -> void
+	{
+		if (o == indi::outcome::success)
+			++(*_p_success_count);
+		else
+			++(*_p_failure_count);
+	}
+
+private:
+	int* _p_success_count = nullptr;
+	int* _p_failure_count = nullptr;
+};
+
+// Basic functor.
+struct outcome_functor_t : outcome_functor_base
+{
+	using outcome_functor_base::outcome_functor_base;
+
+	auto operator()(indi::outcome o) { count(o); }
+};
+
+// Functor with `noexcept` call.
+struct noexcept_outcome_functor_t : outcome_functor_base
+{
+	using outcome_functor_base::outcome_functor_base;
+
+	auto operator()(indi::outcome o) noexcept { count(o); }
+};
+
+// Functor that is move(-construct)-only.
+struct move_only_outcome_functor_t : outcome_functor_base
+{
+	using outcome_functor_base::outcome_functor_base;
+
+	move_only_outcome_functor_t(move_only_outcome_functor_t&&) noexcept = default;
+
+	auto operator()(indi::outcome o) { count(o); }
+
+	move_only_outcome_functor_t(move_only_outcome_functor_t const&) = delete;
+
+	auto operator=(move_only_outcome_functor_t const&) -> move_only_outcome_functor_t& = delete;
+	auto operator=(move_only_outcome_functor_t&&) -> move_only_outcome_functor_t& = delete;
+};
+
+using outcome_functors = std::tuple<
+	outcome_functor_t,
+	noexcept_outcome_functor_t,
+	move_only_outcome_functor_t
+>;
+
+} // anonymous namespace
+
+/*****************************************************************************
+ * Basic operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	basic_operation_WITH_lvalue_CASE_success,
+	Func,
+	outcome_functors)
+{
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	// Artificial scope
+	{
+		auto func = Func{success_count, failure_count};
+		auto const _ = indi::scope_outcome<Func&>{func};
+		BOOST_TEST(success_count + failure_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(success_count == 1);
+	BOOST_TEST(failure_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	basic_operation_WITH_rvalue_CASE_success,
+	Func,
+	outcome_functors)
+{
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_outcome{Func{success_count, failure_count}};
+		BOOST_TEST(success_count + failure_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(success_count == 1);
+	BOOST_TEST(failure_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	basic_operation_WITH_lvalue_CASE_fail,
+	Func,
+	outcome_functors)
+{
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	try
+	{
+		auto func = Func{success_count, failure_count};
+		auto const _ = indi::scope_outcome<Func&>{func};
+		BOOST_TEST(success_count + failure_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(success_count == 0);
+		BOOST_TEST(failure_count == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	basic_operation_WITH_rvalue_CASE_fail,
+	Func,
+	outcome_functors)
+{
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	try
+	{
+		auto const _ = indi::scope_outcome{Func{success_count, failure_count}};
+		BOOST_TEST(success_count + failure_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(success_count == 0);
+		BOOST_TEST(failure_count == 1);
+	}
+}
+
+// A guard created during stack unwinding (in a destructor) should only
+// report failure for exceptions thrown after it was created.
+BOOST_AUTO_TEST_CASE(created_during_unwinding)
+{
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	struct unwinder
+	{
+		int& success_count;
+		int& failure_count;
+
+		~unwinder()
+		{
+			auto const _ = indi::scope_outcome{outcome_functor_t{success_count, failure_count}};
+		}
+	};
+
+	try
+	{
+		auto const _ = unwinder{success_count, failure_count};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(success_count == 1);
+		BOOST_TEST(failure_count == 0);
+	}
+}
+
+/*****************************************************************************
+ * Release operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	release_operation_CASE_success,
+	Func,
+	outcome_functors)
+{
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_outcome{Func{success_count, failure_count}};
+
+		scope_guard.release();
+		BOOST_TEST(success_count + failure_count == 0, "function called by release");
+	}
+
+	BOOST_TEST(success_count + failure_count == 0, "function called despite release");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	release_operation_CASE_fail,
+	Func,
+	outcome_functors)
+{
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	try
+	{
+		auto scope_guard = indi::scope_outcome{Func{success_count, failure_count}};
+
+		scope_guard.release();
+		BOOST_TEST(success_count + failure_count == 0, "function called by release");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(success_count + failure_count == 0, "function called despite release");
+	}
+}
+
+/*****************************************************************************
+ * When initialization of the exit function data member fails, the exit
+ * function argument passed to the constructor should be called with
+ * `outcome::failure`.
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(exit_function_called_on_init_failure)
+{
+	// Function object with `noexcept(false)` move-construction, which should
+	// force scope_outcome to do copy-construction, which will throw.
+	struct functor_t : outcome_functor_base
+	{
+		using outcome_functor_base::outcome_functor_base;
+
+		functor_t(functor_t const& other) : outcome_functor_base{other} { throw indi_test::exception{}; }
+		functor_t(functor_t&& other) noexcept(false) : outcome_functor_base{other} {}
+
+		auto operator()(indi::outcome o) { count(o); }
+	};
+
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	BOOST_CHECK_THROW((indi::scope_outcome{functor_t{success_count, failure_count}}), indi_test::exception);
+	BOOST_TEST(success_count == 0);
+	BOOST_TEST(failure_count == 1);
+}
+
+/*****************************************************************************
+ * Move tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	moving_CASE_success,
+	Func,
+	outcome_functors)
+{
+	using scope_outcome_ptr = std::unique_ptr<indi::scope_outcome<Func>>;
+
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	auto p_scope_guard_1 = scope_outcome_ptr{new indi::scope_outcome{Func{success_count, failure_count}}};
+
+	auto p_scope_guard_2 = scope_outcome_ptr{new indi::scope_outcome{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(success_count + failure_count == 0, "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(success_count + failure_count == 0, "function called by releasing moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(success_count == 1);
+	BOOST_TEST(failure_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	moving_CASE_fail,
+	Func,
+	outcome_functors)
+{
+	using scope_outcome_ptr = std::unique_ptr<indi::scope_outcome<Func>>;
+
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	try
+	{
+		// Outer scope guard, destroyed last.
+		auto p_scope_guard_outer = scope_outcome_ptr{};
+
+		try
+		{
+			// Inner scope guard, destroyed first (after being moved from).
+			auto p_scope_guard_inner = scope_outcome_ptr{new indi::scope_outcome{Func{success_count, failure_count}}};
+
+			p_scope_guard_outer.reset(new indi::scope_outcome{std::move(*p_scope_guard_inner)});
+			BOOST_TEST(success_count + failure_count == 0, "function called by moving scope guard");
+
+			throw indi_test::exception{};
+		}
+		catch (indi_test::exception const&)
+		{
+			BOOST_TEST(success_count + failure_count == 0, "function called by moved-from scope guard");
+
+			throw;
+		}
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(success_count == 0);
+		BOOST_TEST(failure_count == 1);
+	}
+}
+
+/*****************************************************************************
+ * Checkpoint tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	checkpoint_CASE_success,
+	Func,
+	outcome_functors)
+{
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	// Artificial scope
+	{
+		auto const checkpoint = indi::scope_checkpoint{};
+
+		auto const _1 = indi::scope_outcome{checkpoint, Func{success_count, failure_count}};
+		auto const _2 = indi::scope_outcome{checkpoint, Func{success_count, failure_count}};
+		BOOST_TEST(success_count + failure_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(success_count == 2);
+	BOOST_TEST(failure_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	checkpoint_CASE_fail,
+	Func,
+	outcome_functors)
+{
+	auto success_count = 0;
+	auto failure_count = 0;
+
+	try
+	{
+		auto const checkpoint = indi::scope_checkpoint{};
+
+		auto const _1 = indi::scope_outcome{checkpoint, Func{success_count, failure_count}};
+		auto const _2 = indi::scope_outcome{checkpoint, Func{success_count, failure_count}};
+		BOOST_TEST(success_count + failure_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(success_count == 0);
+		BOOST_TEST(failure_count == 2);
+	}
+}
+
+/*****************************************************************************
+ * Special operations
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(special_operations, Func, outcome_functors)
+{
+	BOOST_TEST(not std::is_default_constructible_v<indi::scope_outcome<Func>>);
+	BOOST_TEST(not std::is_copy_constructible_v<indi::scope_outcome<Func>>);
+	BOOST_TEST(not std::is_copy_assignable_v<indi::scope_outcome<Func>>);
+	BOOST_TEST(not std::is_move_assignable_v<indi::scope_outcome<Func>>);
+}
+
+BOOST_AUTO_TEST_CASE(destructor_noexcept)
+{
+	BOOST_TEST(std::is_nothrow_destructible_v<indi::scope_outcome<noexcept_outcome_functor_t>>);
+	BOOST_TEST(not std::is_nothrow_destructible_v<indi::scope_outcome<outcome_functor_t>>);
+}
+
+BOOST_AUTO_TEST_CASE(size)
+{
+	// One function, and one count (rather than two of each for a
+	// scope_success and scope_fail pair).
+	struct function_and_count
+	{
+		outcome_functor_t function;
+		int count;
+	};
+
+	BOOST_TEST(sizeof(indi::scope_outcome<outcome_functor_t>) == sizeof(function_and_count));
+}
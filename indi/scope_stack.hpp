@@ -0,0 +1,424 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#ifndef INDI_INC_scope_stack
+#define INDI_INC_scope_stack
+
+/*****************************************************************************
+ * Scope stack
+ *
+ * A scope_stack is a scope guard for a variable number of exit functions,
+ * registered at run time (for example, one per resource acquired in a loop).
+ * When the stack is destroyed, the functions are called in the reverse of
+ * the order they were registered in, like a sequence of scope guards would
+ * be:
+ *      auto cleanups = scope_stack<256>{};
+ *
+ *      for (auto const& name : names)
+ *      {
+ *          auto const fd = open(name);
+ *          cleanups.on_exit([fd] { close(fd); });
+ *      }
+ *
+ * Each function is registered with a mode: `on_exit()` functions are always
+ * called, `on_fail()` functions only if the stack is destroyed during stack
+ * unwinding, and `on_success()` functions only if it isn't. (Whether the
+ * stack is unwinding is decided like for scope_fail and scope_success, from
+ * the number of uncaught exceptions when the stack was created.)
+ *
+ * The functions are stored (with their type erased) in an arena: memory is
+ * taken from the end of the current chunk, and new chunks are allocated
+ * only when it is full. If `InlineCapacity` is not 0, the first chunk is
+ * that many bytes inside the stack itself, so small stacks don't allocate
+ * at all. All chunks are freed when the stack is destroyed.
+ *
+ * `release_all()` releases every function registered so far in constant
+ * time (they are still destroyed, but not called, when the stack is). If
+ * registering a function fails (because the allocation, or copying or
+ * moving the function, throws), the function is called immediately (unless
+ * it was registered with `on_success()`), like when constructing a scope
+ * guard fails.
+ *
+ * The exit functions are called from the stack's destructor, which is
+ * noexcept: if one throws, the program terminates. A scope_stack can't be
+ * moved or copied.
+ *
+ * When exceptions are disabled, only `on_exit()` is available.
+ ****************************************************************************/
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <indi/scope.hpp>
+
+namespace indi {
+inline namespace v1 {
+
+namespace _detail_X_scope {
+
+// When a scope_stack entry's function is called.
+enum class scope_stack_when : unsigned char
+{
+	exit,
+	fail,
+	success,
+};
+
+struct scope_stack_entry;
+
+struct scope_stack_entry_ops
+{
+	void (*call)(scope_stack_entry*);
+
+	// Null if the function is trivially destructible.
+	void (*destroy)(scope_stack_entry*) noexcept;
+};
+
+// An entry in a scope_stack's arena. The entries form a singly linked list,
+// from the most recently registered one to the first.
+struct scope_stack_entry
+{
+	scope_stack_entry* p_previous;
+	scope_stack_entry_ops const* p_ops;
+	scope_stack_when when;
+};
+
+template <typename F>
+struct scope_stack_entry_for : scope_stack_entry
+{
+	F function;
+};
+
+template <typename F>
+inline constexpr auto scope_stack_entry_ops_for = scope_stack_entry_ops{
+	[](scope_stack_entry* p)
+	{
+		static_cast<scope_stack_entry_for<F>*>(p)->function();
+	},
+	std::is_trivially_destructible_v<F>
+		? nullptr
+		: +[](scope_stack_entry* p) noexcept
+		{
+			std::destroy_at(static_cast<scope_stack_entry_for<F>*>(p));
+		},
+};
+
+// A heap-allocated arena chunk (followed by its memory).
+struct scope_stack_chunk
+{
+	scope_stack_chunk* p_previous;
+	std::size_t size;
+};
+
+// A position in an arena, that it can be rewound to.
+struct scope_stack_arena_position
+{
+	std::byte* p_free;
+	scope_stack_chunk* p_chunk;
+};
+
+// The first arena chunk, inside the scope_stack.
+template <std::size_t Capacity>
+struct scope_stack_inline_chunk
+{
+	alignas(std::max_align_t) std::byte data[Capacity];
+
+	auto begin() noexcept -> std::byte* { return data; }
+	auto end() noexcept -> std::byte* { return data + Capacity; }
+};
+
+template <>
+struct scope_stack_inline_chunk<0>
+{
+	auto begin() noexcept -> std::byte* { return nullptr; }
+	auto end() noexcept -> std::byte* { return nullptr; }
+};
+
+// A bump allocator for scope_stack entries: memory is taken from the end of
+// the current chunk, starting with the inline chunk (if any), and a new
+// chunk is allocated only when it is full. The chunks are freed when the
+// arena is destroyed, or when it is rewound past them (except for the most
+// recent one, which is kept to be reused, so rewinding back and forth
+// across a chunk boundary doesn't allocate every time).
+template <std::size_t InlineCapacity>
+class scope_stack_arena
+{
+public:
+	scope_stack_arena() noexcept = default;
+
+	~scope_stack_arena()
+	{
+		for (auto p = _p_chunks; p != nullptr; )
+		{
+			auto const p_previous = p->p_previous;
+			_free(p);
+			p = p_previous;
+		}
+
+		if (_p_spare != nullptr)
+			_free(_p_spare);
+	}
+
+	auto allocate(std::size_t size, std::size_t alignment) -> void*
+	{
+		auto p = static_cast<void*>(_p_free);
+		auto space = static_cast<std::size_t>(_p_end - _p_free);
+
+		if (p == nullptr or std::align(alignment, size, p, space) == nullptr)
+		{
+			_grow(size + alignment);
+
+			p = _p_free;
+			space = static_cast<std::size_t>(_p_end - _p_free);
+			std::align(alignment, size, p, space);
+		}
+
+		_p_free = static_cast<std::byte*>(p) + size;
+		return p;
+	}
+
+	// Returns the position of the start of the arena.
+	auto start() noexcept -> scope_stack_arena_position
+	{
+		return {_inline_chunk.begin(), nullptr};
+	}
+
+	// Returns the current position.
+	auto mark() const noexcept -> scope_stack_arena_position
+	{
+		return {_p_free, _p_chunks};
+	}
+
+	// Frees everything allocated since `position` was returned by `mark()`
+	// (or everything, if it was returned by `start()`).
+	auto rewind(scope_stack_arena_position position) noexcept -> void
+	{
+		while (_p_chunks != position.p_chunk)
+		{
+			auto const p_previous = _p_chunks->p_previous;
+
+			if (_p_spare != nullptr)
+				_free(_p_spare);
+			_p_spare = _p_chunks;
+
+			_p_chunks = p_previous;
+		}
+
+		_p_free = position.p_free;
+		_p_end = _p_chunks != nullptr
+			? reinterpret_cast<std::byte*>(_p_chunks) + _p_chunks->size
+			: _inline_chunk.end();
+	}
+
+	scope_stack_arena(scope_stack_arena const&) = delete;
+	auto operator=(scope_stack_arena const&) -> scope_stack_arena& = delete;
+
+private:
+	// Heap chunks are at least this big, and each is at least twice as big
+	// as the previous.
+	static constexpr auto _minimum_chunk_size = std::size_t{256};
+
+	static constexpr auto _header_size =
+		(sizeof(scope_stack_chunk) + alignof(std::max_align_t) - 1)
+			/ alignof(std::max_align_t) * alignof(std::max_align_t);
+
+	auto _grow(std::size_t minimum) -> void
+	{
+		auto p_memory = static_cast<std::byte*>(nullptr);
+		auto size = std::size_t{0};
+
+		if (_p_spare != nullptr and _p_spare->size >= _header_size + minimum)
+		{
+			p_memory = reinterpret_cast<std::byte*>(_p_spare);
+			size = _p_spare->size;
+			_p_spare = nullptr;
+		}
+		else
+		{
+			size = _p_chunks != nullptr ? 2 * _p_chunks->size : _minimum_chunk_size;
+			if (size < _header_size + minimum)
+				size = _header_size + minimum;
+
+			p_memory = static_cast<std::byte*>(::operator new(size));
+		}
+
+		_p_chunks = ::new (p_memory) scope_stack_chunk{_p_chunks, size};
+		_p_free = p_memory + _header_size;
+		_p_end = p_memory + size;
+	}
+
+	static auto _free(scope_stack_chunk* p) noexcept -> void
+	{
+		::operator delete(static_cast<void*>(p), p->size);
+	}
+
+	[[no_unique_address]] scope_stack_inline_chunk<InlineCapacity> _inline_chunk;
+
+	std::byte* _p_free = _inline_chunk.begin();
+	std::byte* _p_end = _inline_chunk.end();
+	scope_stack_chunk* _p_chunks = nullptr;
+	scope_stack_chunk* _p_spare = nullptr;
+};
+
+// Creates an entry for `f` in `arena`, on top of `p_top`, and returns it.
+//
+// If that fails, and `CallOnFailure` is true, `f` is called before the
+// exception is propagated, like when constructing a scope guard fails.
+template <bool CallOnFailure, typename Arena, typename EFP>
+auto push_scope_stack_entry(Arena& arena, scope_stack_entry* p_top, scope_stack_when when, EFP&& f)
+	-> scope_stack_entry*
+{
+	using F = std::decay_t<EFP>;
+	using entry_for = scope_stack_entry_for<F>;
+
+	static_assert(std::is_constructible_v<F, EFP> or std::is_constructible_v<F, EFP&>);
+	static_assert(std::is_invocable_v<F&>);
+	static_assert(alignof(entry_for) <= alignof(std::max_align_t),
+		"over-aligned exit functions are not supported");
+
+#ifdef INDI_X_SCOPE_NO_EXCEPTIONS
+	auto const p = arena.allocate(sizeof(entry_for), alignof(entry_for));
+	return ::new (p) entry_for{{p_top, &scope_stack_entry_ops_for<F>, when},
+		move_init_if_noexcept<F, EFP>(f)};
+#else
+	try
+	{
+		auto const p = arena.allocate(sizeof(entry_for), alignof(entry_for));
+		return ::new (p) entry_for{{p_top, &scope_stack_entry_ops_for<F>, when},
+			move_init_if_noexcept<F, EFP>(f)};
+	}
+	catch (...)
+	{
+		if constexpr (CallOnFailure)
+			f();
+		throw;
+	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+}
+
+} // namespace _detail_X_scope
+
+// scope_stack<InlineCapacity>
+//
+// See above.
+template <std::size_t InlineCapacity = 0>
+class scope_stack
+{
+	using entry = _detail_X_scope::scope_stack_entry;
+	using when = _detail_X_scope::scope_stack_when;
+
+public:
+	scope_stack() noexcept
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+	:
+		_uncaught_on_creation{_detail_X_scope::uncaught_exceptions()}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+	{}
+
+	~scope_stack()
+	{
+#ifdef INDI_X_SCOPE_NO_EXCEPTIONS
+		auto const unwinding = false;
+#else
+		auto const unwinding = _detail_X_scope::uncaught_exceptions() > _uncaught_on_creation;
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+		auto const skipped = unwinding ? when::success : when::fail;
+
+		auto armed = true;
+		for (auto p = _p_top; p != nullptr; )
+		{
+			// Everything from the top entry at the last release_all() down is
+			// released.
+			if (p == _p_released_top)
+				armed = false;
+
+			auto const p_previous = p->p_previous;
+
+			if (armed and p->when != skipped)
+				p->p_ops->call(p);
+			if (p->p_ops->destroy != nullptr)
+				p->p_ops->destroy(p);
+
+			p = p_previous;
+		}
+	}
+
+	// Registers a function that is always called.
+	template <typename EFP>
+	auto on_exit(EFP&& f) -> void
+	{
+		_push<when::exit>(std::forward<EFP>(f));
+	}
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+	// Registers a function that is only called if the stack is destroyed
+	// during stack unwinding.
+	template <typename EFP>
+	auto on_fail(EFP&& f) -> void
+	{
+		_push<when::fail>(std::forward<EFP>(f));
+	}
+
+	// Registers a function that is only called if the stack is NOT destroyed
+	// during stack unwinding.
+	template <typename EFP>
+	auto on_success(EFP&& f) -> void
+	{
+		_push<when::success>(std::forward<EFP>(f));
+	}
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+
+	// Releases every function registered so far.
+	auto release_all() noexcept -> void
+	{
+		_p_released_top = _p_top;
+	}
+
+	scope_stack(scope_stack const&) = delete;
+	auto operator=(scope_stack const&) -> scope_stack& = delete;
+
+	// Not movable (the entries may be in the inline chunk).
+	scope_stack(scope_stack&&) = delete;
+	auto operator=(scope_stack&&) -> scope_stack& = delete;
+
+private:
+	template <when When, typename EFP>
+	auto _push(EFP&& f) -> void
+	{
+		_p_top = _detail_X_scope::push_scope_stack_entry<When != when::success>(
+			_arena, _p_top, When, std::forward<EFP>(f));
+	}
+
+	[[no_unique_address]] _detail_X_scope::scope_stack_arena<InlineCapacity> _arena;
+
+	entry* _p_top = nullptr;
+	entry* _p_released_top = nullptr;
+
+#ifndef INDI_X_SCOPE_NO_EXCEPTIONS
+	int _uncaught_on_creation = 0;
+#endif // INDI_X_SCOPE_NO_EXCEPTIONS
+};
+
+} // inline namespace v1
+} // namespace indi
+
+#endif // include guard
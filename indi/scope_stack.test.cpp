@@ -0,0 +1,436 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#define BOOST_TEST_MODULE scope_stack
+#ifdef BOOST_TEST_DYN_LINK
+#	include <boost/test/unit_test.hpp>
+#else
+#	include <boost/test/included/unit_test.hpp>
+#endif // BOOST_TEST_DYN_LINK
+
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <indi/scope_stack.hpp>
+
+#include <indi/scope.test.hpp>
+
+/*****************************************************************************
+ * Allocation counting.
+ *
+ * The global allocation functions are replaced, to count the allocations
+ * made by the scope stacks.
+ ****************************************************************************/
+
+namespace {
+
+auto allocation_count = 0;
+
+} // anonymous namespace
+
+auto operator new(std::size_t size) -> void*
+{
+	++allocation_count;
+
+	if (auto const p = std::malloc(size != 0 ? size : 1))
+		return p;
+
+	throw std::bad_alloc{};
+}
+
+auto operator delete(void* p) noexcept -> void
+{
+	std::free(p);
+}
+
+auto operator delete(void* p, std::size_t) noexcept -> void
+{
+	std::free(p);
+}
+
+namespace {
+
+// Function object that records the order it was called in.
+struct order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	auto operator()() const { p_order->push_back(id); }
+};
+
+} // anonymous namespace
+
+/*****************************************************************************
+ * Basic operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(on_exit_WITH_rvalue, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		stack.on_exit(Func{call_count});
+		stack.on_exit(Func{call_count});
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 2);
+}
+
+BOOST_AUTO_TEST_CASE(on_exit_WITH_function)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		stack.on_exit(indi_test::function);
+		stack.on_exit(&indi_test::function);
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 2);
+}
+
+BOOST_AUTO_TEST_CASE(on_exit_CASE_fail)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto stack = indi::scope_stack<>{};
+		stack.on_exit(indi_test::functor_t<int>{call_count});
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+	auto const _ = indi::scope_stack<>{};
+	BOOST_TEST(true);
+}
+
+// Functions are called in the reverse of the order they were registered in.
+BOOST_AUTO_TEST_CASE(lifo_order)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		for (auto i = 0; i < 1000; ++i)
+			stack.on_exit(order_functor_t{&order, i});
+	}
+
+	BOOST_TEST(order.size() == 1000u);
+	for (auto i = 0; i < static_cast<int>(order.size()); ++i)
+		BOOST_TEST(order[i] == 999 - i);
+}
+
+/*****************************************************************************
+ * Modes
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(modes_CASE_success)
+{
+	auto exit_count = 0;
+	auto fail_count = 0;
+	auto success_count = 0;
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		stack.on_exit(indi_test::functor_t<int>{exit_count});
+		stack.on_fail(indi_test::functor_t<int>{fail_count});
+		stack.on_success(indi_test::functor_t<int>{success_count});
+	}
+
+	BOOST_TEST(exit_count == 1);
+	BOOST_TEST(fail_count == 0);
+	BOOST_TEST(success_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(modes_CASE_fail)
+{
+	auto exit_count = 0;
+	auto fail_count = 0;
+	auto success_count = 0;
+
+	try
+	{
+		auto stack = indi::scope_stack<>{};
+		stack.on_exit(indi_test::functor_t<int>{exit_count});
+		stack.on_fail(indi_test::functor_t<int>{fail_count});
+		stack.on_success(indi_test::functor_t<int>{success_count});
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(exit_count == 1);
+		BOOST_TEST(fail_count == 1);
+		BOOST_TEST(success_count == 0);
+	}
+}
+
+// Like scope_fail, a stack created during stack unwinding only fails if
+// another exception is thrown.
+BOOST_AUTO_TEST_CASE(modes_CASE_created_during_unwinding)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+
+	struct stack_user
+	{
+		int& fail_count;
+		int& success_count;
+
+		~stack_user()
+		{
+			auto stack = indi::scope_stack<>{};
+			stack.on_fail(indi_test::functor_t<int>{fail_count});
+			stack.on_success(indi_test::functor_t<int>{success_count});
+		}
+	};
+
+	try
+	{
+		auto const _ = stack_user{fail_count, success_count};
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+	}
+
+	BOOST_TEST(fail_count == 0);
+	BOOST_TEST(success_count == 1);
+}
+
+/*****************************************************************************
+ * Release tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(release_all)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		for (auto i = 0; i < 10; ++i)
+			stack.on_exit(order_functor_t{&order, i});
+
+		stack.release_all();
+
+		for (auto i = 10; i < 15; ++i)
+			stack.on_exit(order_functor_t{&order, i});
+	}
+
+	BOOST_TEST(order == (std::vector<int>{14, 13, 12, 11, 10}));
+}
+
+BOOST_AUTO_TEST_CASE(release_all_CASE_twice)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		stack.on_exit(indi_test::functor_t<int>{call_count});
+		stack.release_all();
+		stack.on_exit(indi_test::functor_t<int>{call_count});
+		stack.release_all();
+	}
+
+	BOOST_TEST(call_count == 0);
+}
+
+// Released functions are still destroyed.
+BOOST_AUTO_TEST_CASE(release_all_CASE_destroyed)
+{
+	auto const p_shared = std::make_shared<int>(0);
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		stack.on_exit([p_shared] {});
+		BOOST_TEST(p_shared.use_count() == 2);
+
+		stack.release_all();
+		BOOST_TEST(p_shared.use_count() == 2);
+	}
+
+	BOOST_TEST(p_shared.use_count() == 1);
+}
+
+/*****************************************************************************
+ * When registering a function fails, the function should be called (except
+ * for on_success()), like when constructing a scope guard fails.
+ ****************************************************************************/
+
+namespace {
+
+// Function object whose copy constructor throws (so it is copied, not
+// moved).
+class throwing_copy_functor_t
+{
+public:
+	explicit throwing_copy_functor_t(int& counter) : _p_counter{&counter} {}
+	throwing_copy_functor_t(throwing_copy_functor_t const&) { throw indi_test::exception{}; }
+	throwing_copy_functor_t(throwing_copy_functor_t&& other) noexcept(false) : _p_counter{other._p_counter} {}
+
+	auto operator()() { ++(*_p_counter); }
+
+private:
+	int* _p_counter = nullptr;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(exit_function_called_on_push_failure)
+{
+	auto exit_count = 0;
+	auto fail_count = 0;
+	auto success_count = 0;
+	auto other_count = 0;
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		stack.on_exit(indi_test::functor_t<int>{other_count});
+
+		BOOST_CHECK_THROW(stack.on_exit(throwing_copy_functor_t{exit_count}), indi_test::exception);
+		BOOST_CHECK_THROW(stack.on_fail(throwing_copy_functor_t{fail_count}), indi_test::exception);
+		BOOST_CHECK_THROW(stack.on_success(throwing_copy_functor_t{success_count}), indi_test::exception);
+		BOOST_TEST(exit_count == 1);
+		BOOST_TEST(fail_count == 1);
+		BOOST_TEST(success_count == 0);
+		BOOST_TEST(other_count == 0);
+	}
+
+	// The stack is still usable.
+	BOOST_TEST(other_count == 1);
+	BOOST_TEST(exit_count == 1);
+	BOOST_TEST(fail_count == 1);
+	BOOST_TEST(success_count == 0);
+}
+
+/*****************************************************************************
+ * Arena tests
+ ****************************************************************************/
+
+// When everything fits in the inline chunk, nothing is allocated.
+BOOST_AUTO_TEST_CASE(inline_chunk)
+{
+	auto call_count = 0;
+	auto const allocations_before = allocation_count;
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<1024>{};
+		for (auto i = 0; i < 10; ++i)
+			stack.on_exit(indi_test::functor_t<int>{call_count});
+	}
+
+	BOOST_TEST(allocation_count == allocations_before);
+	BOOST_TEST(call_count == 10);
+}
+
+// Chunks grow geometrically, so the number of allocations is logarithmic in
+// the number of functions (rather than one per function).
+BOOST_AUTO_TEST_CASE(chunk_growth)
+{
+	auto call_count = 0;
+	auto const allocations_before = allocation_count;
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<64>{};
+		for (auto i = 0; i < 10000; ++i)
+			stack.on_exit(indi_test::functor_t<int>{call_count});
+	}
+
+	BOOST_TEST(allocation_count - allocations_before <= 20);
+	BOOST_TEST(call_count == 10000);
+}
+
+// Functions bigger than a whole chunk get a chunk of their own.
+BOOST_AUTO_TEST_CASE(large_functions)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<16>{};
+
+		auto big = std::array<char, 4096>{};
+		stack.on_exit([big, &call_count] { call_count += big[0] + 1; });
+		stack.on_exit([big, &call_count] { call_count += big[0] + 1; });
+	}
+
+	BOOST_TEST(call_count == 2);
+}
+
+// Functions with non-trivial destructors are destroyed.
+BOOST_AUTO_TEST_CASE(non_trivial_functions)
+{
+	auto result = std::string{};
+
+	// Artificial scope
+	{
+		auto stack = indi::scope_stack<>{};
+		for (auto i = 0; i < 100; ++i)
+			stack.on_exit([&result, s = std::string(100, static_cast<char>('a' + i % 26))] { result += s[0]; });
+	}
+
+	BOOST_TEST(result.size() == 100u);
+	BOOST_TEST(result.front() == 'a' + 99 % 26);
+}
+
+/*****************************************************************************
+ * Special operations
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(special_operations)
+{
+	BOOST_TEST(not std::is_copy_constructible_v<indi::scope_stack<>>);
+	BOOST_TEST(not std::is_move_constructible_v<indi::scope_stack<>>);
+	BOOST_TEST(not std::is_copy_assignable_v<indi::scope_stack<>>);
+	BOOST_TEST(not std::is_move_assignable_v<indi::scope_stack<>>);
+	BOOST_TEST(std::is_nothrow_destructible_v<indi::scope_stack<>>);
+}
+
+BOOST_AUTO_TEST_CASE(size)
+{
+	// Without an inline chunk, only the arena pointers, the top and
+	// released entries, and the uncaught exception count.
+	BOOST_TEST(sizeof(indi::scope_stack<>) <= 7 * sizeof(void*));
+	BOOST_TEST(sizeof(indi::scope_stack<256>) <= 256 + 7 * sizeof(void*) + alignof(std::max_align_t));
+}
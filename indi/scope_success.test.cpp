@@ -25,6 +25,7 @@
 #endif // BOOST_TEST_DYN_LINK
 
 #include <memory>
+#include <vector>
 
 #include <indi/scope.hpp>
 
@@ -318,6 +319,786 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(
 	BOOST_TEST(call_count == 0, "function called despite release");
 }
 
+/*****************************************************************************
+ * Checkpoint tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	checkpoint_WITH_rvalue_CASE_success,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const checkpoint = indi::scope_checkpoint{};
+
+		auto const _1 = indi::scope_success{checkpoint, Func{call_count}};
+		auto const _2 = indi::scope_success{checkpoint, Func{call_count}};
+		auto const _3 = indi::scope_success{checkpoint, Func{call_count}};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 3);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	checkpoint_WITH_lvalue_CASE_fail,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto const checkpoint = indi::scope_checkpoint{};
+
+		auto func = Func{call_count};
+		auto const _1 = indi::scope_success<Func&>{checkpoint, func};
+		auto const _2 = indi::scope_success<Func&>{checkpoint, func};
+		auto const _3 = indi::scope_success<Func&>{checkpoint, func};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	checkpoint_WITH_rvalue_CASE_fail,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto const checkpoint = indi::scope_checkpoint{};
+
+		auto const _1 = indi::scope_success{checkpoint, Func{call_count}};
+		auto const _2 = indi::scope_success{checkpoint, Func{call_count}};
+		auto const _3 = indi::scope_success{checkpoint, Func{call_count}};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 0);
+	}
+}
+
+// A checkpoint taken during stack unwinding (in a destructor) should only
+// count exceptions thrown after it was taken.
+BOOST_AUTO_TEST_CASE(checkpoint_created_during_unwinding)
+{
+	auto call_count = 0;
+
+	struct unwinder
+	{
+		int& call_count;
+
+		~unwinder()
+		{
+			auto const checkpoint = indi::scope_checkpoint{};
+			BOOST_TEST(checkpoint.uncaught_on_creation() == 1);
+			BOOST_TEST(not checkpoint.unwinding());
+
+			auto const _ = indi::scope_success{checkpoint, indi_test::functor_t<int>{call_count}};
+		}
+	};
+
+	try
+	{
+		auto const _ = unwinder{call_count};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+	}
+}
+
+/*****************************************************************************
+ * scope_success_fn tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(scope_success_fn_basic_operation_CASE_success)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_success_fn<&indi_test::function>{};
+		BOOST_TEST(indi_test::function_call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_fn_basic_operation_CASE_fail)
+{
+	indi_test::function_call_count = 0;
+
+	try
+	{
+		auto const _ = indi::scope_success_fn<&indi_test::function>{};
+		BOOST_TEST(indi_test::function_call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(indi_test::function_call_count == 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_fn_basic_operation_WITH_lambda)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_success_fn<[] { indi_test::function(); }>{};
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_fn_release_operation_CASE_success)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_success_fn<&indi_test::function>{};
+
+		scope_guard.release();
+		BOOST_TEST(indi_test::function_call_count == 0, "function called by release");
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 0, "function called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_fn_release_operation_CASE_fail)
+{
+	indi_test::function_call_count = 0;
+
+	try
+	{
+		auto scope_guard = indi::scope_success_fn<&indi_test::function>{};
+
+		scope_guard.release();
+		BOOST_TEST(indi_test::function_call_count == 0, "function called by release");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(indi_test::function_call_count == 0, "function called despite release");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_fn_moving)
+{
+	using scope_success_ptr = std::unique_ptr<indi::scope_success_fn<&indi_test::function>>;
+
+	indi_test::function_call_count = 0;
+
+	auto p_scope_guard_1 = scope_success_ptr{new indi::scope_success_fn<&indi_test::function>{}};
+
+	auto p_scope_guard_2 = scope_success_ptr{new indi::scope_success_fn{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(indi_test::function_call_count == 0, "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(indi_test::function_call_count == 0, "function called by releasing moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_fn_size)
+{
+	// Only the minimal state is stored - not the function.
+	BOOST_TEST(sizeof(indi::scope_success_fn<&indi_test::function>) == sizeof(int));
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_fn_special_operations)
+{
+	using guard_t = indi::scope_success_fn<&indi_test::function>;
+
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guard_t>);
+
+	// Like scope_success, the destructor can throw if the function can.
+	BOOST_TEST(not std::is_nothrow_destructible_v<guard_t>);
+}
+
+/*****************************************************************************
+ * scope_success_ref tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_success_ref_basic_operation_CASE_success,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto func = Func{call_count};
+		auto const _ = indi::scope_success_ref{func};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_success_ref_basic_operation_CASE_fail,
+	Func,
+	indi_test::lvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto func = Func{call_count};
+		auto const _ = indi::scope_success_ref{func};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_ref_basic_operation_WITH_function)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_success_ref{indi_test::function};
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_ref_release_operation)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto func = indi_test::functor_t<int>{call_count};
+		auto scope_guard = indi::scope_success_ref{func};
+
+		scope_guard.release();
+		BOOST_TEST(call_count == 0, "function called by release");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 0, "function called despite release");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_ref_moving)
+{
+	using scope_guard_ptr = std::unique_ptr<indi::scope_success_ref>;
+
+	auto call_count = 0;
+	auto func = indi_test::functor_t<int>{call_count};
+
+	auto p_scope_guard_1 = scope_guard_ptr{new indi::scope_success_ref{func}};
+
+	auto p_scope_guard_2 = scope_guard_ptr{new indi::scope_success_ref{std::move(*p_scope_guard_1)}};
+	BOOST_TEST(call_count == 0, "function called by moving scope guard");
+
+	p_scope_guard_1.reset();
+	BOOST_TEST(call_count == 0, "function called by releasing moved-from scope guard");
+
+	p_scope_guard_2.reset();
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_ref_size)
+{
+	// Only a pointer to the function and a pointer to the thunk are stored
+	// (plus the minimal state).
+	BOOST_TEST(sizeof(indi::scope_success_ref) == 3 * sizeof(void*));
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_ref_special_operations)
+{
+	using guard_t = indi::scope_success_ref;
+
+	BOOST_TEST(not std::is_default_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_nothrow_destructible_v<guard_t>);
+
+	// The function must outlive the guard, so it can't be a temporary.
+	BOOST_TEST((not std::is_constructible_v<guard_t, indi_test::functor_t<int>>));
+	BOOST_TEST((std::is_constructible_v<guard_t, indi_test::functor_t<int>&>));
+}
+
+/*****************************************************************************
+ * Execute and rearm tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(execute_CASE_success, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_success{Func{call_count}};
+
+		scope_guard.execute();
+		BOOST_TEST(call_count == 1);
+
+		scope_guard.execute();
+		BOOST_TEST(call_count == 1, "function called twice by execute");
+	}
+
+	BOOST_TEST(call_count == 1, "function called by destructor after execute");
+}
+
+// During stack unwinding, execute() doesn't call the function.
+BOOST_AUTO_TEST_CASE(execute_CASE_fail)
+{
+	using guard_t = indi::scope_success<indi_test::functor_t<int>>;
+
+	auto call_count = 0;
+
+	struct executor
+	{
+		guard_t& guard;
+
+		~executor() { guard.execute(); }
+	};
+
+	// Artificial scope
+	{
+		auto scope_guard = guard_t{indi_test::functor_t<int>{call_count}};
+
+		try
+		{
+			auto const _ = executor{scope_guard};
+			throw indi_test::exception{};
+		}
+		catch (indi_test::exception const&)
+		{
+			BOOST_TEST(call_count == 0, "function called on failure");
+		}
+	}
+
+	BOOST_TEST(call_count == 0, "function called after execute");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(rearm, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_success{Func{call_count}};
+
+		scope_guard.execute();
+		scope_guard.rearm();
+	}
+
+	BOOST_TEST(call_count == 2);
+}
+
+namespace {
+
+auto rearm_function_pointer_call_count = 0;
+
+auto rearm_function_pointer_function() -> void
+{
+	++rearm_function_pointer_call_count;
+}
+
+} // anonymous namespace
+
+// Unlike scope_exit, the released state is stored in the uncaught exception
+// count, so a guard holding a function pointer can be re-armed too.
+BOOST_AUTO_TEST_CASE(rearm_CASE_function_pointer)
+{
+	rearm_function_pointer_call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_success{&rearm_function_pointer_function};
+
+		scope_guard.release();
+		scope_guard.rearm();
+	}
+
+	BOOST_TEST(rearm_function_pointer_call_count == 1);
+}
+
+// A guard can be reused in each iteration of a loop.
+BOOST_AUTO_TEST_CASE(rearm_CASE_loop)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_success{indi_test::functor_t<int>{call_count}};
+
+		for (auto i = 0; i < 10; ++i)
+		{
+			scope_guard.rearm();
+			scope_guard.execute();
+		}
+
+		BOOST_TEST(call_count == 10);
+	}
+
+	BOOST_TEST(call_count == 10);
+}
+
+/*****************************************************************************
+ * scope_success_assignable tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_success_assignable_basic_operation,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_success_assignable{Func{call_count}};
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+
+	try
+	{
+		auto const _ = indi::scope_success_assignable{Func{call_count}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1, "function called on failure");
+	}
+}
+
+// Move-assigning ends the assigned-to guard as if it went out of scope, so
+// outside of stack unwinding, its function is called.
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+	scope_success_assignable_move_assignment,
+	Func,
+	indi_test::rvalue_functors<int>)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard_1 = indi::scope_success_assignable{Func{call_count_1}};
+		auto scope_guard_2 = indi::scope_success_assignable{Func{call_count_2}};
+
+		scope_guard_1 = std::move(scope_guard_2);
+		BOOST_TEST(call_count_1 == 1);
+		BOOST_TEST(call_count_2 == 0, "function called by moving scope guard");
+	}
+
+	BOOST_TEST(call_count_1 == 1);
+	BOOST_TEST(call_count_2 == 1);
+}
+
+namespace {
+
+// Functor whose call throws.
+struct throwing_call_functor_t : indi_test::functor_base<int>
+{
+	using indi_test::functor_base<int>::functor_base;
+
+	auto operator()() -> void
+	{
+		increment_counter();
+		throw indi_test::exception{};
+	}
+};
+
+} // anonymous namespace
+
+// If the assigned-to guard's function throws, the assignment still happens.
+BOOST_AUTO_TEST_CASE(scope_success_assignable_move_assignment_CASE_throwing)
+{
+	using guard_t = indi::scope_success_assignable<throwing_call_functor_t>;
+
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	BOOST_TEST(not std::is_nothrow_move_assignable_v<guard_t>);
+
+	try
+	{
+		auto scope_guard_1 = guard_t{throwing_call_functor_t{call_count_1}};
+		auto scope_guard_2 = guard_t{throwing_call_functor_t{call_count_2}};
+
+		BOOST_CHECK_THROW(scope_guard_1 = std::move(scope_guard_2), indi_test::exception);
+		BOOST_TEST(call_count_1 == 1);
+
+		scope_guard_2.release();
+		scope_guard_1.release();
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_FAIL("released function called");
+	}
+
+	BOOST_TEST(call_count_1 == 1);
+	BOOST_TEST(call_count_2 == 0);
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_assignable_swap)
+{
+	auto call_count_1 = 0;
+	auto call_count_2 = 0;
+
+	// Artificial scope
+	{
+		auto scope_guard_1 = indi::scope_success_assignable{indi_test::functor_t<int>{call_count_1}};
+		auto scope_guard_2 = indi::scope_success_assignable{indi_test::functor_t<int>{call_count_2}};
+
+		scope_guard_1.release();
+		scope_guard_1.swap(scope_guard_2);
+		BOOST_TEST(call_count_1 == 0, "function called by swap");
+		BOOST_TEST(call_count_2 == 0, "function called by swap");
+	}
+
+	BOOST_TEST(call_count_1 == 0);
+	BOOST_TEST(call_count_2 == 1);
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_assignable_is_trivially_relocatable)
+{
+	BOOST_TEST(indi::is_trivially_relocatable_v<indi::scope_success_assignable<void (*)()>>);
+	BOOST_TEST(not indi::is_trivially_relocatable_v<indi::scope_success<void (*)()>>);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(scope_success_assignable_special_operations, Func, indi_test::nonthrowing_functors<int>)
+{
+	using guard_t = indi::scope_success_assignable<Func>;
+
+	BOOST_TEST(not std::is_default_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_swappable_v<guard_t>);
+	BOOST_TEST(std::is_final_v<guard_t>);
+}
+
+/*****************************************************************************
+ * scope_success_all tests
+ ****************************************************************************/
+
+namespace {
+
+// Function object that records the order it was called in.
+struct order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	auto operator()() const noexcept { p_order->push_back(id); }
+};
+
+// Like order_functor_t, but copying throws (and moving may throw, so it is
+// copied).
+struct throwing_copy_order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	throwing_copy_order_functor_t(std::vector<int>* p, int i) : p_order{p}, id{i} {}
+	throwing_copy_order_functor_t(throwing_copy_order_functor_t const&) { throw indi_test::exception{}; }
+	throwing_copy_order_functor_t(throwing_copy_order_functor_t&& other) noexcept(false)
+		: p_order{other.p_order}, id{other.id} {}
+
+	auto operator()() const noexcept { p_order->push_back(id); }
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(scope_success_all_basic_operation_CASE_success)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_success_all{
+			order_functor_t{&order, 1},
+			order_functor_t{&order, 2},
+			order_functor_t{&order, 3}};
+		BOOST_TEST(order.empty(), "function called before scope exit");
+	}
+
+	BOOST_TEST(order == (std::vector<int>{3, 2, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_all_basic_operation_CASE_fail)
+{
+	auto order = std::vector<int>{};
+
+	try
+	{
+		auto const _ = indi::scope_success_all{order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(order.empty(), "function called on failure");
+	}
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(scope_success_all_basic_operation_WITH_rvalue, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::scope_success_all{Func{call_count}, Func{call_count}};
+	}
+
+	BOOST_TEST(call_count == 2);
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_all_release_operation)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_success_all{order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+		scope_guard.release();
+	}
+
+	BOOST_TEST(order.empty(), "function called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_all_execute_and_rearm)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto scope_guard = indi::scope_success_all{order_functor_t{&order, 1}, order_functor_t{&order, 2}};
+
+		scope_guard.execute();
+		BOOST_TEST(order == (std::vector<int>{2, 1}));
+
+		scope_guard.rearm();
+	}
+
+	BOOST_TEST(order == (std::vector<int>{2, 1, 2, 1}));
+}
+
+// When initializing one of the functions fails, none are called, like for
+// a sequence of scope_success guards.
+BOOST_AUTO_TEST_CASE(scope_success_all_exit_function_not_called_on_init_failure)
+{
+	auto order = std::vector<int>{};
+
+	BOOST_CHECK_THROW(
+		(indi::scope_success_all{
+			order_functor_t{&order, 1},
+			throwing_copy_order_functor_t{&order, 2},
+			order_functor_t{&order, 3}}),
+		indi_test::exception);
+
+	BOOST_TEST(order.empty());
+}
+
+namespace {
+
+// Function object whose call records its id, then throws.
+struct throwing_call_order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	auto operator()() const -> void
+	{
+		p_order->push_back(id);
+		throw indi_test::exception{};
+	}
+};
+
+} // anonymous namespace
+
+// If a function throws, the ones before it are not called.
+BOOST_AUTO_TEST_CASE(scope_success_all_throwing_function)
+{
+	using guard_t = indi::scope_success_all<order_functor_t, throwing_call_order_functor_t, order_functor_t>;
+
+	auto order = std::vector<int>{};
+
+	BOOST_TEST(not std::is_nothrow_destructible_v<guard_t>);
+
+	try
+	{
+		auto const _ = guard_t{
+			order_functor_t{&order, 1},
+			throwing_call_order_functor_t{&order, 2},
+			order_functor_t{&order, 3}};
+	}
+	catch (indi_test::exception const&)
+	{
+	}
+
+	BOOST_TEST(order == (std::vector<int>{3, 2}));
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_all_size)
+{
+	auto const empty_1 = [] {};
+	auto const empty_2 = [] {};
+
+	// Only the uncaught exception count, shared by all the functions.
+	BOOST_TEST(sizeof(indi::scope_success_all{empty_1, empty_2}) == sizeof(int));
+}
+
+BOOST_AUTO_TEST_CASE(scope_success_all_special_operations)
+{
+	using guard_t = indi::scope_success_all<indi_test::noexcept_functor_t<int>, indi_test::const_noexcept_functor_t<int>>;
+
+	BOOST_TEST(not std::is_default_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_constructible_v<guard_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<guard_t>);
+	BOOST_TEST(not std::is_move_assignable_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_move_constructible_v<guard_t>);
+	BOOST_TEST(std::is_nothrow_destructible_v<guard_t>);
+
+	// The destructor may throw if any of the functions may.
+	BOOST_TEST((not std::is_nothrow_destructible_v<
+		indi::scope_success_all<indi_test::noexcept_functor_t<int>, indi_test::functor_t<int>>>));
+}
+
 /*****************************************************************************
  * Special operations
  ****************************************************************************/
@@ -0,0 +1,279 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+// Compares transactions (and their savepoints) against the equivalent
+// sequences (and nested scopes) of scope_fail guards.
+//
+// Each step increments a counter, and registers a function to decrement it
+// again. The following are measured:
+//  *   steps :                 a sequence of steps, that succeeds.
+//  *   steps (unwind) :        a sequence of steps, ending with an exception.
+//  *   phases :                a sequence of steps, some of them in nested
+//                              phases, that all succeed.
+//  *   phases (inner failure): the same, but the innermost phase fails, is
+//                              rolled back on its own, and the rest
+//                              carries on.
+
+#include <array>
+#include <cstdio>
+#include <utility>
+
+#include <indi/scope.hpp>
+#include <indi/transaction.hpp>
+
+#include <indi/scope.bench.hpp>
+#include <indi/scope.test.hpp>
+
+namespace {
+
+int counter = 0;
+
+// Set to true to make maybe_throw() throw. Never actually set, but the
+// compiler can't know that.
+volatile bool should_throw = false;
+
+[[gnu::noinline]] auto maybe_throw() -> void
+{
+	if (should_throw)
+		throw indi_test::exception{};
+}
+
+[[gnu::noinline]] auto always_throw() -> void
+{
+	throw indi_test::exception{};
+}
+
+auto step() -> void { ++counter; }
+auto undo() -> void { --counter; }
+
+/*****************************************************************************
+ * Flat sequences of steps.
+ ****************************************************************************/
+
+template <int N>
+[[gnu::noinline]] auto guarded_steps() -> void
+{
+	[]<int... Is>(std::integer_sequence<int, Is...>)
+	{
+		// One guard per step, each living until the end of the sequence.
+		auto const step_and_guard = [](int)
+		{
+			step();
+			return indi::scope_fail{undo};
+		};
+
+		[[maybe_unused]] auto const guards = std::array{step_and_guard(Is)...};
+		maybe_throw();
+	}(std::make_integer_sequence<int, N>{});
+}
+
+template <int N>
+[[gnu::noinline]] auto transaction_steps() -> void
+{
+	auto t = indi::transaction<>{};
+	for (auto i = 0; i < N; ++i)
+	{
+		step();
+		t.on_rollback(undo);
+	}
+
+	maybe_throw();
+	t.commit();
+}
+
+template <int N>
+[[gnu::noinline]] auto guarded_steps_unwind() -> void
+{
+	try
+	{
+		[]<int... Is>(std::integer_sequence<int, Is...>)
+		{
+			auto const step_and_guard = [](int)
+			{
+				step();
+				return indi::scope_fail{undo};
+			};
+
+			[[maybe_unused]] auto const guards = std::array{step_and_guard(Is)...};
+			always_throw();
+		}(std::make_integer_sequence<int, N>{});
+	}
+	catch (indi_test::exception const&)
+	{}
+}
+
+template <int N>
+[[gnu::noinline]] auto transaction_steps_unwind() -> void
+{
+	try
+	{
+		auto t = indi::transaction<>{};
+		for (auto i = 0; i < N; ++i)
+		{
+			step();
+			t.on_rollback(undo);
+		}
+
+		always_throw();
+		t.commit();
+	}
+	catch (indi_test::exception const&)
+	{}
+}
+
+/*****************************************************************************
+ * Nested phases.
+ *
+ * Three nested phases of two steps each. With guards, each inner phase is
+ * an inner scope, and its guards are gone once it succeeds, so the
+ * enclosing phase needs one more guard to undo it if a later step fails.
+ * With a transaction, each inner phase is a savepoint.
+ ****************************************************************************/
+
+template <bool InnerFails>
+[[gnu::noinline]] auto guarded_phases() -> void
+{
+	step();
+	auto const _1 = indi::scope_fail{undo};
+	step();
+	auto const _2 = indi::scope_fail{undo};
+
+	// Undoes the inner phases, if they succeeded but a later step fails.
+	auto phase_2_done = 0;
+	auto const _phase_2 = indi::scope_fail{[&phase_2_done] { counter -= phase_2_done; }};
+	try
+	{
+		step();
+		auto const _3 = indi::scope_fail{undo};
+		step();
+		auto const _4 = indi::scope_fail{undo};
+
+		auto phase_3_done = 0;
+		auto const _phase_3 = indi::scope_fail{[&phase_3_done] { counter -= phase_3_done; }};
+		try
+		{
+			step();
+			auto const _5 = indi::scope_fail{undo};
+			step();
+			auto const _6 = indi::scope_fail{undo};
+
+			if constexpr (InnerFails)
+				always_throw();
+			else
+				maybe_throw();
+
+			phase_3_done = 2;
+		}
+		catch (indi_test::exception const&)
+		{}
+
+		maybe_throw();
+		phase_2_done = 2 + phase_3_done;
+	}
+	catch (indi_test::exception const&)
+	{}
+
+	maybe_throw();
+}
+
+template <bool InnerFails>
+[[gnu::noinline]] auto transaction_phases() -> void
+{
+	auto t = indi::transaction<>{};
+	step();
+	t.on_rollback(undo);
+	step();
+	t.on_rollback(undo);
+
+	auto const phase_2 = t.savepoint();
+	try
+	{
+		step();
+		t.on_rollback(undo);
+		step();
+		t.on_rollback(undo);
+
+		auto const phase_3 = t.savepoint();
+		try
+		{
+			step();
+			t.on_rollback(undo);
+			step();
+			t.on_rollback(undo);
+
+			if constexpr (InnerFails)
+				always_throw();
+			else
+				maybe_throw();
+		}
+		catch (indi_test::exception const&)
+		{
+			t.rollback_to(phase_3);
+		}
+
+		maybe_throw();
+	}
+	catch (indi_test::exception const&)
+	{
+		t.rollback_to(phase_2);
+	}
+
+	maybe_throw();
+	t.commit();
+}
+
+/*****************************************************************************
+ * Running and reporting.
+ ****************************************************************************/
+
+template <int N>
+auto run_steps() -> void
+{
+	auto const name = [](char const* what)
+	{
+		static char buffer[128];
+		std::snprintf(buffer, sizeof(buffer), "transaction vs scope_fail: %d %s", N, what);
+		return buffer;
+	};
+
+	indi_bench::report(name("steps"),
+		indi_bench::measure(transaction_steps<N>),
+		indi_bench::measure(guarded_steps<N>));
+	indi_bench::report(name("steps (unwind)"),
+		indi_bench::measure(transaction_steps_unwind<N>),
+		indi_bench::measure(guarded_steps_unwind<N>));
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+	run_steps<1>();
+	run_steps<4>();
+	run_steps<16>();
+
+	indi_bench::report("savepoints vs nested scope_fail: phases",
+		indi_bench::measure(transaction_phases<false>),
+		indi_bench::measure(guarded_phases<false>));
+	indi_bench::report("savepoints vs nested scope_fail: phases (inner failure)",
+		indi_bench::measure(transaction_phases<true>),
+		indi_bench::measure(guarded_phases<true>));
+
+	indi_bench::do_not_optimize(counter);
+}
@@ -0,0 +1,216 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#ifndef INDI_INC_transaction
+#define INDI_INC_transaction
+
+/*****************************************************************************
+ * Transaction
+ *
+ * A transaction collects undo functions for a sequence of steps, and calls
+ * them (in the reverse of the order they were registered in) when it is
+ * destroyed, unless it was committed first:
+ *      auto t = transaction<>{};
+ *
+ *      by_name.insert(name, id);
+ *      t.on_rollback([&] { by_name.erase(name); });
+ *
+ *      by_id.insert(id, name); // may throw
+ *      t.on_rollback([&] { by_id.erase(id); });
+ *
+ *      t.commit();
+ *
+ * That is the equivalent of a sequence of scope_fail guards, but the undo
+ * functions are stored (with their type erased) in a single arena, like a
+ * scope_stack's, rather than each in its own guard, and `commit()` discards
+ * them all in constant time. If `InlineCapacity` is not 0 (by default, it's
+ * 256 bytes), the first chunk of the arena is inside the transaction itself,
+ * so small transactions don't allocate at all.
+ *
+ * Unlike a scope_fail, a transaction doesn't need to know whether it is
+ * destroyed during stack unwinding, so it never checks for uncaught
+ * exceptions: leaving the scope of a transaction that wasn't committed, for
+ * any reason, rolls it back. (So it also works when exceptions are
+ * disabled.)
+ *
+ * Nested phases can be rolled back on their own with savepoints.
+ * `savepoint()` returns a marker, and `rollback_to()` calls (and discards)
+ * only the undo functions registered since then, freeing the arena memory
+ * they used, while the rest of the transaction carries on:
+ *      auto const phase_3 = t.savepoint();
+ *      try
+ *      {
+ *          run_phase_3(t);
+ *      }
+ *      catch (phase_error const&)
+ *      {
+ *          t.rollback_to(phase_3);
+ *      }
+ *
+ * There is nothing to do to release a savepoint (to merge the steps since
+ * then into the enclosing phase): they already are part of it, so a
+ * savepoint that isn't rolled back to can simply be dropped. `rollback()`
+ * rolls back the whole transaction. A savepoint is only valid until the
+ * transaction is rolled back to before it.
+ *
+ * Rolling back to a savepoint from before the last `commit()` only calls
+ * the undo functions registered since the commit. The committed steps stay
+ * committed: their undo functions are discarded without being called, so
+ * afterwards, nothing before the savepoint can be rolled back any more (not
+ * even by `rollback()`).
+ *
+ * Undo functions registered after `commit()` are part of a new transaction:
+ * they are called unless `commit()` is called again. If registering an undo
+ * function fails (because the allocation, or copying or moving the
+ * function, throws), the function is called immediately, like when
+ * constructing a scope_fail fails, and the exception is propagated (so the
+ * rest of the transaction is rolled back as well, unless it is caught).
+ *
+ * The undo functions are called from the transaction's destructor, which is
+ * noexcept: if one throws, the program terminates. A transaction can't be
+ * moved or copied.
+ ****************************************************************************/
+
+#include <cstddef>
+#include <utility>
+
+#include <indi/scope_stack.hpp>
+
+namespace indi {
+inline namespace v1 {
+
+template <std::size_t InlineCapacity>
+class transaction;
+
+// transaction_savepoint
+//
+// A position in a transaction, that it can be rolled back to.
+class transaction_savepoint
+{
+	template <std::size_t InlineCapacity>
+	friend class transaction;
+
+	transaction_savepoint(_detail_X_scope::scope_stack_entry* p_top,
+		_detail_X_scope::scope_stack_arena_position position) noexcept
+	:
+		_p_top{p_top},
+		_position{position}
+	{}
+
+	_detail_X_scope::scope_stack_entry* _p_top;
+	_detail_X_scope::scope_stack_arena_position _position;
+};
+
+// transaction<InlineCapacity>
+//
+// See above.
+template <std::size_t InlineCapacity = 256>
+class transaction
+{
+	using entry = _detail_X_scope::scope_stack_entry;
+
+public:
+	transaction() noexcept = default;
+
+	~transaction()
+	{
+		_unwind(nullptr);
+	}
+
+	// Registers a function that undoes the last step.
+	template <typename EFP>
+	auto on_rollback(EFP&& f) -> void
+	{
+		_p_top = _detail_X_scope::push_scope_stack_entry<true>(
+			_arena, _p_top, _detail_X_scope::scope_stack_when::exit, std::forward<EFP>(f));
+	}
+
+	// Commits every step so far (so their undo functions won't be called).
+	auto commit() noexcept -> void
+	{
+		_p_committed_top = _p_top;
+	}
+
+	// Returns a savepoint for the current position.
+	auto savepoint() const noexcept -> transaction_savepoint
+	{
+		return {_p_top, _arena.mark()};
+	}
+
+	// Rolls back every step since `savepoint` (but only calls the undo
+	// functions of the steps since the last commit; see above).
+	auto rollback_to(transaction_savepoint savepoint) noexcept -> void
+	{
+		_unwind(savepoint._p_top);
+		_arena.rewind(savepoint._position);
+	}
+
+	// Rolls back every step so far.
+	auto rollback() noexcept -> void
+	{
+		_unwind(nullptr);
+		_arena.rewind(_arena.start());
+	}
+
+	transaction(transaction const&) = delete;
+	auto operator=(transaction const&) -> transaction& = delete;
+
+	// Not movable (the entries may be in the inline chunk).
+	transaction(transaction&&) = delete;
+	auto operator=(transaction&&) -> transaction& = delete;
+
+private:
+	// Calls the undo functions of the entries above `p_bottom` (unless they
+	// are committed), and destroys them.
+	auto _unwind(entry* p_bottom) noexcept -> void
+	{
+		auto armed = true;
+		for (auto p = _p_top; p != p_bottom; )
+		{
+			// Everything from the top entry at the last commit() down is
+			// committed.
+			if (p == _p_committed_top)
+			{
+				armed = false;
+				_p_committed_top = p_bottom;
+			}
+
+			auto const p_previous = p->p_previous;
+
+			if (armed)
+				p->p_ops->call(p);
+			if (p->p_ops->destroy != nullptr)
+				p->p_ops->destroy(p);
+
+			p = p_previous;
+		}
+
+		_p_top = p_bottom;
+	}
+
+	[[no_unique_address]] _detail_X_scope::scope_stack_arena<InlineCapacity> _arena;
+
+	entry* _p_top = nullptr;
+	entry* _p_committed_top = nullptr;
+};
+
+} // inline namespace v1
+} // namespace indi
+
+#endif // include guard
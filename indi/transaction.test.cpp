@@ -0,0 +1,646 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#define BOOST_TEST_MODULE transaction
+#ifdef BOOST_TEST_DYN_LINK
+#	include <boost/test/unit_test.hpp>
+#else
+#	include <boost/test/included/unit_test.hpp>
+#endif // BOOST_TEST_DYN_LINK
+
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <indi/transaction.hpp>
+
+#include <indi/scope.test.hpp>
+
+/*****************************************************************************
+ * Allocation counting.
+ *
+ * The global allocation functions are replaced, to count the allocations
+ * made by the transactions.
+ ****************************************************************************/
+
+namespace {
+
+auto allocation_count = 0;
+
+} // anonymous namespace
+
+auto operator new(std::size_t size) -> void*
+{
+	++allocation_count;
+
+	if (auto const p = std::malloc(size != 0 ? size : 1))
+		return p;
+
+	throw std::bad_alloc{};
+}
+
+auto operator delete(void* p) noexcept -> void
+{
+	std::free(p);
+}
+
+auto operator delete(void* p, std::size_t) noexcept -> void
+{
+	std::free(p);
+}
+
+namespace {
+
+// Function object that records the order it was called in.
+struct order_functor_t
+{
+	std::vector<int>* p_order;
+	int id;
+
+	auto operator()() const { p_order->push_back(id); }
+};
+
+} // anonymous namespace
+
+/*****************************************************************************
+ * Basic operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(on_rollback_WITH_rvalue, Func, indi_test::rvalue_functors<int>)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(Func{call_count});
+		t.on_rollback(Func{call_count});
+		BOOST_TEST(call_count == 0, "function called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 2);
+}
+
+BOOST_AUTO_TEST_CASE(on_rollback_WITH_function)
+{
+	indi_test::function_call_count = 0;
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(indi_test::function);
+		t.on_rollback(&indi_test::function);
+	}
+
+	BOOST_TEST(indi_test::function_call_count == 2);
+}
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+	// Artificial scope
+	{
+		auto const _ = indi::transaction<>{};
+	}
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.commit();
+	}
+
+	BOOST_TEST(true);
+}
+
+// Undo functions are called in the reverse of the order they were
+// registered in.
+BOOST_AUTO_TEST_CASE(lifo_order)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		for (auto i = 0; i < 1000; ++i)
+			t.on_rollback(order_functor_t{&order, i});
+	}
+
+	BOOST_TEST(order.size() == 1000u);
+	for (auto i = 0; i < static_cast<int>(order.size()); ++i)
+		BOOST_TEST(order[i] == 999 - i);
+}
+
+/*****************************************************************************
+ * Commit and rollback tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(commit)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		for (auto i = 0; i < 100; ++i)
+			t.on_rollback(indi_test::functor_t<int>{call_count});
+
+		t.commit();
+	}
+
+	BOOST_TEST(call_count == 0);
+}
+
+BOOST_AUTO_TEST_CASE(rollback_CASE_fail)
+{
+	auto call_count = 0;
+
+	try
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(indi_test::functor_t<int>{call_count});
+		t.on_rollback(indi_test::functor_t<int>{call_count});
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 2);
+	}
+}
+
+// A transaction that isn't committed is rolled back even without an
+// exception (for example, on an early return).
+BOOST_AUTO_TEST_CASE(rollback_CASE_early_return)
+{
+	auto call_count = 0;
+
+	auto const f = [&call_count](bool fail)
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(indi_test::functor_t<int>{call_count});
+
+		if (fail)
+			return;
+
+		t.commit();
+	};
+
+	f(false);
+	BOOST_TEST(call_count == 0);
+
+	f(true);
+	BOOST_TEST(call_count == 1);
+}
+
+// A transaction created (or destroyed) during stack unwinding works the same.
+BOOST_AUTO_TEST_CASE(rollback_CASE_during_unwinding)
+{
+	auto committed_count = 0;
+	auto rolled_back_count = 0;
+
+	struct transaction_user
+	{
+		int& committed_count;
+		int& rolled_back_count;
+
+		~transaction_user()
+		{
+			// Artificial scope
+			{
+				auto t = indi::transaction<>{};
+				t.on_rollback(indi_test::functor_t<int>{committed_count});
+				t.commit();
+			}
+
+			// Artificial scope
+			{
+				auto t = indi::transaction<>{};
+				t.on_rollback(indi_test::functor_t<int>{rolled_back_count});
+			}
+		}
+	};
+
+	try
+	{
+		auto const _ = transaction_user{committed_count, rolled_back_count};
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+	}
+
+	BOOST_TEST(committed_count == 0);
+	BOOST_TEST(rolled_back_count == 1);
+}
+
+// Undo functions registered after a commit are a new transaction.
+BOOST_AUTO_TEST_CASE(on_rollback_after_commit)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		for (auto i = 0; i < 10; ++i)
+			t.on_rollback(order_functor_t{&order, i});
+
+		t.commit();
+
+		for (auto i = 10; i < 15; ++i)
+			t.on_rollback(order_functor_t{&order, i});
+	}
+
+	BOOST_TEST(order == (std::vector<int>{14, 13, 12, 11, 10}));
+}
+
+// Committed functions are still destroyed.
+BOOST_AUTO_TEST_CASE(commit_CASE_destroyed)
+{
+	auto const p_shared = std::make_shared<int>(0);
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback([p_shared] {});
+		BOOST_TEST(p_shared.use_count() == 2);
+
+		t.commit();
+		BOOST_TEST(p_shared.use_count() == 2);
+	}
+
+	BOOST_TEST(p_shared.use_count() == 1);
+}
+
+// A multi-step update of several containers is all or nothing.
+BOOST_AUTO_TEST_CASE(multi_step_update)
+{
+	auto by_name = std::map<std::string, int>{};
+	auto by_id = std::map<int, std::string>{};
+
+	auto const add = [&](std::string const& name, int id, bool fail)
+	{
+		auto t = indi::transaction<>{};
+
+		by_name.emplace(name, id);
+		t.on_rollback([&by_name, name] { by_name.erase(name); });
+
+		by_id.emplace(id, name);
+		t.on_rollback([&by_id, id] { by_id.erase(id); });
+
+		if (fail)
+			throw indi_test::exception{};
+
+		t.commit();
+	};
+
+	add("one", 1, false);
+	BOOST_CHECK_THROW(add("two", 2, true), indi_test::exception);
+	add("three", 3, false);
+
+	BOOST_TEST(by_name.size() == 2u);
+	BOOST_TEST(by_id.size() == 2u);
+	BOOST_TEST(by_name.count("two") == 0u);
+	BOOST_TEST(by_id.count(2) == 0u);
+}
+
+/*****************************************************************************
+ * Savepoint tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(rollback_to)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(order_functor_t{&order, 0});
+		t.on_rollback(order_functor_t{&order, 1});
+
+		auto const savepoint = t.savepoint();
+		t.on_rollback(order_functor_t{&order, 2});
+		t.on_rollback(order_functor_t{&order, 3});
+
+		t.rollback_to(savepoint);
+		BOOST_TEST(order == (std::vector<int>{3, 2}));
+
+		// The transaction carries on.
+		t.on_rollback(order_functor_t{&order, 4});
+	}
+
+	BOOST_TEST(order == (std::vector<int>{3, 2, 4, 1, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(rollback_to_CASE_nothing_since)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		auto const savepoint_1 = t.savepoint();
+		t.rollback_to(savepoint_1);
+
+		t.on_rollback(indi_test::functor_t<int>{call_count});
+		auto const savepoint_2 = t.savepoint();
+		t.rollback_to(savepoint_2);
+		BOOST_TEST(call_count == 0);
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+BOOST_AUTO_TEST_CASE(nested_savepoints)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(order_functor_t{&order, 0});
+
+		auto const outer = t.savepoint();
+		t.on_rollback(order_functor_t{&order, 1});
+
+		auto const inner = t.savepoint();
+		t.on_rollback(order_functor_t{&order, 2});
+
+		t.rollback_to(inner);
+		BOOST_TEST(order == (std::vector<int>{2}));
+
+		t.on_rollback(order_functor_t{&order, 3});
+
+		t.rollback_to(outer);
+		BOOST_TEST(order == (std::vector<int>{2, 3, 1}));
+
+		t.commit();
+	}
+
+	BOOST_TEST(order == (std::vector<int>{2, 3, 1}));
+}
+
+// A savepoint that isn't rolled back to is merged into the enclosing phase.
+BOOST_AUTO_TEST_CASE(released_savepoint)
+{
+	auto order = std::vector<int>{};
+
+	try
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(order_functor_t{&order, 0});
+
+		// Phase that succeeds.
+		{
+			[[maybe_unused]] auto const savepoint = t.savepoint();
+			t.on_rollback(order_functor_t{&order, 1});
+		}
+
+		// Phase that fails.
+		{
+			auto const savepoint = t.savepoint();
+			try
+			{
+				t.on_rollback(order_functor_t{&order, 2});
+				throw indi_test::exception{};
+			}
+			catch (indi_test::exception const&)
+			{
+				t.rollback_to(savepoint);
+			}
+		}
+
+		BOOST_TEST(order == (std::vector<int>{2}));
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+	}
+
+	BOOST_TEST(order == (std::vector<int>{2, 1, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(rollback)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(order_functor_t{&order, 0});
+		t.on_rollback(order_functor_t{&order, 1});
+
+		t.rollback();
+		BOOST_TEST(order == (std::vector<int>{1, 0}));
+
+		t.on_rollback(order_functor_t{&order, 2});
+	}
+
+	BOOST_TEST(order == (std::vector<int>{1, 0, 2}));
+}
+
+// Rolling back to before a commit doesn't call the committed functions
+// (but destroys them).
+BOOST_AUTO_TEST_CASE(rollback_to_CASE_committed)
+{
+	auto order = std::vector<int>{};
+	auto const p_shared = std::make_shared<int>(0);
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(order_functor_t{&order, 0});
+
+		auto const savepoint = t.savepoint();
+		t.on_rollback(order_functor_t{&order, 1});
+		t.on_rollback([p_shared] {});
+		t.commit();
+		t.on_rollback(order_functor_t{&order, 2});
+
+		t.rollback_to(savepoint);
+		BOOST_TEST(order == (std::vector<int>{2}));
+		BOOST_TEST(p_shared.use_count() == 1);
+
+		t.on_rollback(order_functor_t{&order, 3});
+	}
+
+	BOOST_TEST(order == (std::vector<int>{2, 3}));
+}
+
+// After rolling back to before a commit, the committed steps (and the ones
+// before the savepoint) are never rolled back, even by rollback().
+BOOST_AUTO_TEST_CASE(rollback_to_CASE_committed_CASE_then_rollback)
+{
+	auto order = std::vector<int>{};
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(order_functor_t{&order, 0});
+
+		auto const savepoint = t.savepoint();
+		t.on_rollback(order_functor_t{&order, 1});
+		t.commit();
+		t.on_rollback(order_functor_t{&order, 2});
+
+		t.rollback_to(savepoint);
+		BOOST_TEST(order == (std::vector<int>{2}));
+
+		t.on_rollback(order_functor_t{&order, 3});
+		t.rollback();
+		BOOST_TEST(order == (std::vector<int>{2, 3}));
+
+		t.on_rollback(order_functor_t{&order, 4});
+	}
+
+	BOOST_TEST(order == (std::vector<int>{2, 3, 4}));
+}
+
+// Rolling back frees the arena memory used since the savepoint, so a loop
+// of savepoints and rollbacks doesn't keep allocating.
+BOOST_AUTO_TEST_CASE(rollback_to_CASE_reuses_memory)
+{
+	auto call_count = 0;
+	auto t = indi::transaction<0>{};
+
+	// Fill the first chunk, so each iteration crosses a chunk boundary.
+	for (auto i = 0; i < 1000; ++i)
+		t.on_rollback(indi_test::functor_t<int>{call_count});
+
+	auto const allocations_before = allocation_count;
+	for (auto i = 0; i < 1000; ++i)
+	{
+		auto const savepoint = t.savepoint();
+		for (auto j = 0; j < 100; ++j)
+			t.on_rollback(indi_test::functor_t<int>{call_count});
+		t.rollback_to(savepoint);
+	}
+
+	BOOST_TEST(allocation_count - allocations_before <= 2);
+	BOOST_TEST(call_count == 1000 * 100);
+
+	t.commit();
+}
+
+/*****************************************************************************
+ * When registering an undo function fails, it should be called, like when
+ * constructing a scope_fail fails.
+ ****************************************************************************/
+
+namespace {
+
+// Function object whose copy constructor throws (so it is copied, not
+// moved).
+class throwing_copy_functor_t
+{
+public:
+	explicit throwing_copy_functor_t(int& counter) : _p_counter{&counter} {}
+	throwing_copy_functor_t(throwing_copy_functor_t const&) { throw indi_test::exception{}; }
+	throwing_copy_functor_t(throwing_copy_functor_t&& other) noexcept(false) : _p_counter{other._p_counter} {}
+
+	auto operator()() { ++(*_p_counter); }
+
+private:
+	int* _p_counter = nullptr;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(undo_function_called_on_push_failure)
+{
+	auto failed_count = 0;
+	auto other_count = 0;
+
+	try
+	{
+		auto t = indi::transaction<>{};
+		t.on_rollback(indi_test::functor_t<int>{other_count});
+
+		t.on_rollback(throwing_copy_functor_t{failed_count});
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(failed_count == 1);
+		BOOST_TEST(other_count == 1);
+	}
+}
+
+/*****************************************************************************
+ * Arena tests
+ ****************************************************************************/
+
+// When everything fits in the inline chunk, nothing is allocated.
+BOOST_AUTO_TEST_CASE(inline_chunk)
+{
+	auto call_count = 0;
+	auto const allocations_before = allocation_count;
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<>{};
+		for (auto i = 0; i < 8; ++i)
+			t.on_rollback(indi_test::functor_t<int>{call_count});
+	}
+
+	BOOST_TEST(allocation_count == allocations_before);
+	BOOST_TEST(call_count == 8);
+}
+
+// Past the inline chunk, the log spills to the heap.
+BOOST_AUTO_TEST_CASE(spill)
+{
+	auto call_count = 0;
+	auto const allocations_before = allocation_count;
+
+	// Artificial scope
+	{
+		auto t = indi::transaction<64>{};
+		for (auto i = 0; i < 10000; ++i)
+			t.on_rollback(indi_test::functor_t<int>{call_count});
+	}
+
+	BOOST_TEST(allocation_count - allocations_before <= 20);
+	BOOST_TEST(call_count == 10000);
+}
+
+/*****************************************************************************
+ * Special operations
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(special_operations)
+{
+	BOOST_TEST(not std::is_copy_constructible_v<indi::transaction<>>);
+	BOOST_TEST(not std::is_move_constructible_v<indi::transaction<>>);
+	BOOST_TEST(not std::is_copy_assignable_v<indi::transaction<>>);
+	BOOST_TEST(not std::is_move_assignable_v<indi::transaction<>>);
+	BOOST_TEST(std::is_nothrow_destructible_v<indi::transaction<>>);
+	BOOST_TEST(std::is_nothrow_default_constructible_v<indi::transaction<>>);
+
+	BOOST_TEST(std::is_trivially_copyable_v<indi::transaction_savepoint>);
+	BOOST_TEST(not std::is_default_constructible_v<indi::transaction_savepoint>);
+}
+
+BOOST_AUTO_TEST_CASE(size)
+{
+	BOOST_TEST(sizeof(indi::transaction<0>) <= 6 * sizeof(void*));
+	BOOST_TEST(sizeof(indi::transaction<256>) <= 256 + 6 * sizeof(void*) + alignof(std::max_align_t));
+	BOOST_TEST(sizeof(indi::transaction_savepoint) == 3 * sizeof(void*));
+}
@@ -0,0 +1,72 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+// Compares `std::uncaught_exceptions()` with the fast path enabled by
+// INDI_SCOPE_FAST_UNCAUGHT_EXCEPTIONS, both on their own and as used by
+// scope_fail.
+
+#include <exception>
+
+#define INDI_SCOPE_FAST_UNCAUGHT_EXCEPTIONS
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.bench.hpp>
+
+namespace {
+
+int counter = 0;
+
+auto undo() noexcept -> void { ++counter; }
+
+[[gnu::noinline]] auto guard_std() -> void
+{
+	auto const uncaught_on_creation = std::uncaught_exceptions();
+
+	indi_bench::clobber_memory();
+
+	if (std::uncaught_exceptions() > uncaught_on_creation)
+		undo();
+}
+
+[[gnu::noinline]] auto guard_fast() -> void
+{
+	auto const _ = indi::scope_fail{undo};
+
+	indi_bench::clobber_memory();
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+	if (not indi::_detail_X_scope::has_fast_uncaught_exceptions)
+		std::printf("(fast path not supported; both measure std::uncaught_exceptions())\n");
+
+	indi_bench::report("std::uncaught_exceptions()",
+		indi_bench::measure([] { indi_bench::do_not_optimize(std::uncaught_exceptions()); }));
+	indi_bench::report("fast uncaught_exceptions()",
+		indi_bench::measure([] { indi_bench::do_not_optimize(indi::_detail_X_scope::uncaught_exceptions()); }));
+	indi_bench::report("hand-written scope_fail, std",
+		indi_bench::measure(guard_std));
+	indi_bench::report("scope_fail, fast",
+		indi_bench::measure(guard_fast));
+
+	indi_bench::do_not_optimize(counter);
+}
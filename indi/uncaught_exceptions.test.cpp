@@ -0,0 +1,209 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#define BOOST_TEST_MODULE uncaught_exceptions
+#ifdef BOOST_TEST_DYN_LINK
+#	include <boost/test/unit_test.hpp>
+#else
+#	include <boost/test/included/unit_test.hpp>
+#endif // BOOST_TEST_DYN_LINK
+
+#include <exception>
+
+// Tests the fast path, wherever it is supported.
+#define INDI_SCOPE_FAST_UNCAUGHT_EXCEPTIONS
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.test.hpp>
+
+/*****************************************************************************
+ * The fast path must always agree with std::uncaught_exceptions().
+ ****************************************************************************/
+
+namespace {
+
+// Checks that both counts agree, and are the expected value.
+auto check_count(int expected) -> void
+{
+	BOOST_TEST(std::uncaught_exceptions() == expected);
+	BOOST_TEST(indi::_detail_X_scope::uncaught_exceptions() == expected);
+}
+
+// Checks the count when destroyed.
+struct checker
+{
+	int expected;
+
+	~checker() { check_count(expected); }
+};
+
+} // anonymous namespace
+
+#if defined(__GLIBCXX__) or defined(_LIBCPP_VERSION)
+BOOST_AUTO_TEST_CASE(fast_path_enabled)
+{
+	BOOST_TEST(indi::_detail_X_scope::has_fast_uncaught_exceptions);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(no_exception)
+{
+	check_count(0);
+}
+
+BOOST_AUTO_TEST_CASE(during_unwinding)
+{
+	try
+	{
+		auto const _ = checker{1};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		// A caught exception is no longer uncaught.
+		check_count(0);
+	}
+
+	check_count(0);
+}
+
+BOOST_AUTO_TEST_CASE(nested_exceptions)
+{
+	// Destroyed during unwinding, and throws (and catches) another exception
+	// while the first is still uncaught.
+	struct nester
+	{
+		~nester()
+		{
+			check_count(1);
+
+			try
+			{
+				auto const _ = checker{2};
+
+				throw indi_test::exception{};
+			}
+			catch (indi_test::exception const&)
+			{
+				check_count(1);
+			}
+
+			check_count(1);
+		}
+	};
+
+	try
+	{
+		auto const _ = nester{};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		check_count(0);
+	}
+
+	check_count(0);
+}
+
+BOOST_AUTO_TEST_CASE(rethrow)
+{
+	try
+	{
+		try
+		{
+			throw indi_test::exception{};
+		}
+		catch (indi_test::exception const&)
+		{
+			check_count(0);
+
+			auto const _ = checker{1};
+
+			throw;
+		}
+	}
+	catch (indi_test::exception const&)
+	{
+		check_count(0);
+	}
+
+	check_count(0);
+}
+
+BOOST_AUTO_TEST_CASE(rethrow_exception)
+{
+	auto p_exception = std::exception_ptr{};
+
+	try
+	{
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		p_exception = std::current_exception();
+	}
+
+	try
+	{
+		auto const _ = checker{1};
+
+		std::rethrow_exception(p_exception);
+	}
+	catch (indi_test::exception const&)
+	{
+		check_count(0);
+	}
+
+	check_count(0);
+}
+
+/*****************************************************************************
+ * Scope guards still work with the fast path.
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(scope_guards)
+{
+	auto fail_count = 0;
+	auto success_count = 0;
+
+	try
+	{
+		auto const _1 = indi::scope_fail{indi_test::functor_t<int>{fail_count}};
+		auto const _2 = indi::scope_success{indi_test::functor_t<int>{success_count}};
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(fail_count == 1);
+		BOOST_TEST(success_count == 0);
+	}
+
+	// Artificial scope
+	{
+		auto const _1 = indi::scope_fail{indi_test::functor_t<int>{fail_count}};
+		auto const _2 = indi::scope_success{indi_test::functor_t<int>{success_count}};
+	}
+
+	BOOST_TEST(fail_count == 1);
+	BOOST_TEST(success_count == 1);
+}
@@ -0,0 +1,113 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Codegen tests for unique_resource
+ *
+ * With an empty deleter, and a resource type that has an invalid value (see
+ * resource_traits), a unique_resource is just the resource handle. Each
+ * `<case>__actual` function must compile to exactly the same instructions
+ * as the matching `<case>__expected` function, which is the hand-written
+ * check-and-close. (See tools/compare-codegen.sh.)
+ *
+ * The work done in the scope is `noexcept`, for the same reason as in the
+ * scope_exit_always codegen tests.
+ ****************************************************************************/
+
+#include <indi/scope.hpp>
+
+// Resource handle type with an invalid value.
+enum class fd : int {};
+
+template <>
+struct indi::resource_traits<fd>
+{
+	static constexpr auto invalid() noexcept -> fd { return fd{-1}; }
+};
+
+// Opaque functions, so that the calls can't be optimized away.
+auto open_fd() noexcept -> fd;
+auto close_fd(fd) noexcept -> void;
+auto work(fd) noexcept -> void;
+
+// Empty deleter.
+struct closer_t
+{
+	auto operator()(fd f) const noexcept -> void { close_fd(f); }
+};
+
+extern "C" auto construct__actual(fd f) -> void
+{
+	auto const r = indi::unique_resource{f, closer_t{}};
+	work(r.get());
+}
+
+extern "C" auto construct__expected(fd f) -> void
+{
+	work(f);
+	if (f != fd{-1})
+		close_fd(f);
+}
+
+extern "C" auto make_unique_resource_checked__actual() -> void
+{
+	auto const r = indi::make_unique_resource_checked(open_fd(), fd{-1}, closer_t{});
+	if (r.get() == fd{-1})
+		return;
+
+	work(r.get());
+}
+
+extern "C" auto make_unique_resource_checked__expected() -> void
+{
+	auto const f = open_fd();
+	if (f != fd{-1})
+	{
+		work(f);
+		close_fd(f);
+	}
+}
+
+extern "C" auto release__actual(fd f, bool keep) -> fd
+{
+	auto r = indi::unique_resource{f, closer_t{}};
+	work(r.get());
+
+	if (keep)
+	{
+		auto const result = r.get();
+		r.release();
+		return result;
+	}
+
+	return fd{-1};
+}
+
+extern "C" auto release__expected(fd f, bool keep) -> fd
+{
+	work(f);
+
+	if (keep)
+		return f;
+
+	if (f != fd{-1})
+		close_fd(f);
+
+	return fd{-1};
+}
@@ -0,0 +1,679 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+#define BOOST_TEST_MODULE unique_resource
+#ifdef BOOST_TEST_DYN_LINK
+#	include <boost/test/unit_test.hpp>
+#else
+#	include <boost/test/included/unit_test.hpp>
+#endif // BOOST_TEST_DYN_LINK
+
+#include <memory>
+#include <utility>
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.test.hpp>
+
+/*****************************************************************************
+ * Basic operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(basic_operation_CASE_success)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto const _ = indi::unique_resource{42, indi_test::deleter_t{call_count, last_resource}};
+		BOOST_TEST(call_count == 0, "deleter called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+	BOOST_TEST(last_resource == 42);
+}
+
+BOOST_AUTO_TEST_CASE(basic_operation_CASE_fail)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	try
+	{
+		auto const _ = indi::unique_resource{42, indi_test::deleter_t{call_count, last_resource}};
+		BOOST_TEST(call_count == 0, "deleter called before scope exit");
+
+		throw indi_test::exception{};
+	}
+	catch (indi_test::exception const&)
+	{
+		BOOST_TEST(call_count == 1);
+		BOOST_TEST(last_resource == 42);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(get)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	auto const r = indi::unique_resource{42, indi_test::deleter_t{call_count, last_resource}};
+
+	BOOST_TEST(r.get() == 42);
+}
+
+BOOST_AUTO_TEST_CASE(reference_resource)
+{
+	auto resource = 42;
+
+	auto p_resource = static_cast<int*>(nullptr);
+	auto const deleter = [&p_resource](int& r) { p_resource = &r; };
+
+	// Artificial scope
+	{
+		auto const r = indi::unique_resource<int&, decltype(deleter)>{resource, deleter};
+		BOOST_TEST(&r.get() == &resource);
+	}
+
+	BOOST_TEST(p_resource == &resource);
+}
+
+BOOST_AUTO_TEST_CASE(pointer_resource)
+{
+	auto resource = std::pair{1, 2};
+
+	auto const r = indi::unique_resource{&resource, [](auto) {}};
+
+	BOOST_TEST(&(*r) == &resource);
+	BOOST_TEST(r->second == 2);
+}
+
+BOOST_AUTO_TEST_CASE(default_construction)
+{
+	// Artificial scope
+	{
+		auto const r = indi::unique_resource<int, indi_test::empty_deleter_t>{};
+		BOOST_TEST(r.get() == 0);
+	}
+
+	BOOST_TEST(indi_test::empty_deleter_t::call_count == 0, "deleter called for default constructed resource");
+}
+
+/*****************************************************************************
+ * Release and reset operation tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(release_operation)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto r = indi::unique_resource{42, indi_test::deleter_t{call_count, last_resource}};
+
+		r.release();
+		BOOST_TEST(call_count == 0, "deleter called by release");
+		BOOST_TEST(r.get() == 42, "release changed resource");
+	}
+
+	BOOST_TEST(call_count == 0, "deleter called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(reset_operation)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto r = indi::unique_resource{42, indi_test::deleter_t{call_count, last_resource}};
+
+		r.reset();
+		BOOST_TEST(call_count == 1);
+		BOOST_TEST(last_resource == 42);
+
+		r.reset();
+		BOOST_TEST(call_count == 1, "deleter called twice by reset");
+	}
+
+	BOOST_TEST(call_count == 1, "deleter called again after reset");
+}
+
+BOOST_AUTO_TEST_CASE(reset_with_new_resource_operation)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto r = indi::unique_resource{42, indi_test::deleter_t{call_count, last_resource}};
+
+		r.reset(69);
+		BOOST_TEST(call_count == 1);
+		BOOST_TEST(last_resource == 42);
+		BOOST_TEST(r.get() == 69);
+	}
+
+	BOOST_TEST(call_count == 2);
+	BOOST_TEST(last_resource == 69);
+}
+
+BOOST_AUTO_TEST_CASE(reset_with_new_resource_after_release)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto r = indi::unique_resource{42, indi_test::deleter_t{call_count, last_resource}};
+
+		r.release();
+		r.reset(69);
+		BOOST_TEST(call_count == 0, "deleter called for released resource");
+	}
+
+	BOOST_TEST(call_count == 1);
+	BOOST_TEST(last_resource == 69);
+}
+
+/*****************************************************************************
+ * When initialization of the resource or deleter fails, the deleter should
+ * be called on the resource.
+ *
+ * (Reference: P0052r10 7.6.1.6)
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(deleter_called_on_resource_init_failure)
+{
+	// Resource with `noexcept(false)` move-construction, which should force
+	// unique_resource to do copy-construction, which will throw.
+	struct resource_t
+	{
+		explicit resource_t(int v) : value{v} {}
+		resource_t(resource_t const& other) : value{other.value} { throw indi_test::exception{}; }
+		resource_t(resource_t&& other) noexcept(false) : value{other.value} {}
+
+		int value = 0;
+	};
+
+	auto call_count = 0;
+	auto last_resource = 0;
+	auto const deleter = [&](resource_t const& r) noexcept { ++call_count; last_resource = r.value; };
+
+	BOOST_CHECK_THROW((indi::unique_resource{resource_t{42}, deleter}), indi_test::exception);
+	BOOST_TEST(call_count == 1);
+	BOOST_TEST(last_resource == 42);
+}
+
+BOOST_AUTO_TEST_CASE(deleter_called_on_deleter_init_failure)
+{
+	// Deleter with `noexcept(false)` move-construction, which should force
+	// unique_resource to do copy-construction, which will throw.
+	class deleter_t
+	{
+	public:
+		explicit deleter_t(int& counter) : _p_counter{&counter} {}
+		deleter_t(deleter_t const& other) : _p_counter{other._p_counter} { throw indi_test::exception{}; }
+		deleter_t(deleter_t&& other) noexcept(false) : _p_counter{other._p_counter} {}
+
+		auto operator()(int) const noexcept { ++(*_p_counter); }
+
+	private:
+		int* _p_counter = nullptr;
+	};
+
+	auto call_count = 0;
+
+	BOOST_CHECK_THROW((indi::unique_resource{42, deleter_t{call_count}}), indi_test::exception);
+	BOOST_TEST(call_count == 1);
+}
+
+namespace {
+
+// Deleter with a (deleted) `operator,` that would be picked over the built-in
+// comma operator if unique_resource used a comma with a deleter operand.
+class comma_deleter_t
+{
+public:
+	explicit comma_deleter_t(int& counter) noexcept : _p_counter{&counter} {}
+
+	auto operator()(int) const noexcept { ++(*_p_counter); }
+
+private:
+	int* _p_counter = nullptr;
+};
+
+template <typename T>
+auto operator,(T const&, comma_deleter_t const&) -> void = delete;
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(deleter_with_comma_operator)
+{
+	auto call_count = 0;
+
+	// Artificial scope
+	{
+		auto r1 = indi::unique_resource{42, comma_deleter_t{call_count}};
+		auto const r2 = std::move(r1);
+	}
+
+	BOOST_TEST(call_count == 1);
+}
+
+/*****************************************************************************
+ * Move tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(moving)
+{
+	using resource_t = indi::unique_resource<int, indi_test::deleter_t<int>>;
+
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	auto p_resource_1 = std::unique_ptr<resource_t>{new resource_t{42, indi_test::deleter_t{call_count, last_resource}}};
+
+	auto p_resource_2 = std::unique_ptr<resource_t>{new resource_t{std::move(*p_resource_1)}};
+	BOOST_TEST(call_count == 0, "deleter called by moving resource");
+	BOOST_TEST(p_resource_2->get() == 42);
+
+	p_resource_1.reset();
+	BOOST_TEST(call_count == 0, "deleter called by destroying moved-from resource");
+
+	p_resource_2.reset();
+	BOOST_TEST(call_count == 1);
+	BOOST_TEST(last_resource == 42);
+}
+
+BOOST_AUTO_TEST_CASE(moving_CASE_released)
+{
+	using resource_t = indi::unique_resource<int, indi_test::deleter_t<int>>;
+
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	auto p_resource_1 = std::unique_ptr<resource_t>{new resource_t{42, indi_test::deleter_t{call_count, last_resource}}};
+
+	p_resource_1->release();
+
+	auto p_resource_2 = std::unique_ptr<resource_t>{new resource_t{std::move(*p_resource_1)}};
+
+	p_resource_1.reset();
+	p_resource_2.reset();
+	BOOST_TEST(call_count == 0, "deleter called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(move_assignment)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto r1 = indi::unique_resource{42, indi_test::deleter_t{call_count, last_resource}};
+		auto r2 = indi::unique_resource{69, indi_test::deleter_t{call_count, last_resource}};
+
+		r2 = std::move(r1);
+		BOOST_TEST(call_count == 1, "assigned-to resource not deleted");
+		BOOST_TEST(last_resource == 69);
+		BOOST_TEST(r2.get() == 42);
+	}
+
+	BOOST_TEST(call_count == 2, "resource deleted twice (or not at all)");
+	BOOST_TEST(last_resource == 42);
+}
+
+/*****************************************************************************
+ * make_unique_resource_checked() tests
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(make_unique_resource_checked_CASE_valid)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto const r = indi::make_unique_resource_checked(42, -1, indi_test::deleter_t{call_count, last_resource});
+		BOOST_TEST(r.get() == 42);
+	}
+
+	BOOST_TEST(call_count == 1);
+	BOOST_TEST(last_resource == 42);
+}
+
+BOOST_AUTO_TEST_CASE(make_unique_resource_checked_CASE_invalid)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto const r = indi::make_unique_resource_checked(-1, -1, indi_test::deleter_t{call_count, last_resource});
+		BOOST_TEST(r.get() == -1);
+	}
+
+	BOOST_TEST(call_count == 0, "deleter called for invalid resource");
+}
+
+/*****************************************************************************
+ * Storage tests
+ *
+ * An empty deleter should take no space at all, so a unique_resource should
+ * be no larger than the resource handle plus the "execute on reset" flag.
+ ****************************************************************************/
+
+namespace {
+
+template <typename R>
+struct handle_and_flag
+{
+	R resource;
+	bool flag;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(empty_deleter_takes_no_space)
+{
+	constexpr auto lambda = [](auto) {};
+
+	BOOST_TEST(sizeof(indi::unique_resource<int, indi_test::empty_deleter_t>) <= sizeof(handle_and_flag<int>));
+	BOOST_TEST(sizeof(indi::unique_resource<int, decltype(lambda)>) <= sizeof(handle_and_flag<int>));
+	BOOST_TEST(sizeof(indi::unique_resource<void*, indi_test::empty_deleter_t>) <= sizeof(handle_and_flag<void*>));
+	BOOST_TEST(sizeof(indi::unique_resource<int&, indi_test::empty_deleter_t>) <= sizeof(handle_and_flag<int*>));
+}
+
+BOOST_AUTO_TEST_CASE(function_pointer_deleter_size)
+{
+	BOOST_TEST(sizeof(indi::unique_resource<int, void(*)(int)>) <= sizeof(void(*)(int)) + sizeof(handle_and_flag<int>));
+}
+
+/*****************************************************************************
+ * Invalid resource tests
+ *
+ * When resource_traits is specialized for the resource type, the invalid
+ * resource value is used to track ownership instead of a flag.
+ ****************************************************************************/
+
+namespace {
+
+// File-descriptor-like resource handle with invalid value -1.
+enum class test_fd : int {};
+
+constexpr auto invalid_fd = test_fd{-1};
+
+} // anonymous namespace
+
+template <>
+struct indi::resource_traits<test_fd>
+{
+	static constexpr auto invalid() noexcept -> test_fd { return invalid_fd; }
+};
+
+namespace {
+
+// Deleter for test_fd that records calls in the same way as
+// indi_test::deleter_t.
+class fd_deleter_t
+{
+public:
+	explicit fd_deleter_t(int& counter, int& last_resource) noexcept :
+		_p_counter{&counter},
+		_p_last_resource{&last_resource}
+	{}
+
+	auto operator()(test_fd fd) const noexcept
+	{
+		++(*_p_counter);
+		*_p_last_resource = static_cast<int>(fd);
+	}
+
+private:
+	int* _p_counter = nullptr;
+	int* _p_last_resource = nullptr;
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_basic_operation)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto const r = indi::unique_resource{test_fd{3}, fd_deleter_t{call_count, last_resource}};
+		BOOST_TEST(call_count == 0, "deleter called before scope exit");
+	}
+
+	BOOST_TEST(call_count == 1);
+	BOOST_TEST(last_resource == 3);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_release)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto r = indi::unique_resource{test_fd{3}, fd_deleter_t{call_count, last_resource}};
+
+		r.release();
+		BOOST_TEST(call_count == 0, "deleter called by release");
+		BOOST_TEST((r.get() == invalid_fd), "release did not invalidate resource");
+	}
+
+	BOOST_TEST(call_count == 0, "deleter called despite release");
+}
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_reset)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto r = indi::unique_resource{test_fd{3}, fd_deleter_t{call_count, last_resource}};
+
+		r.reset();
+		BOOST_TEST(call_count == 1);
+		BOOST_TEST(last_resource == 3);
+		BOOST_TEST((r.get() == invalid_fd), "reset did not invalidate resource");
+
+		r.reset(test_fd{4});
+		BOOST_TEST(call_count == 1, "deleter called for invalid resource");
+	}
+
+	BOOST_TEST(call_count == 2);
+	BOOST_TEST(last_resource == 4);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_construct_with_invalid)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto const r = indi::unique_resource{invalid_fd, fd_deleter_t{call_count, last_resource}};
+	}
+
+	BOOST_TEST(call_count == 0, "deleter called for invalid resource");
+}
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_default_construction)
+{
+	using resource_t = indi::unique_resource<test_fd, indi_test::empty_deleter_t>;
+
+	auto const call_count = indi_test::empty_deleter_t::call_count;
+
+	// Artificial scope
+	{
+		auto const r = resource_t{};
+		BOOST_TEST((r.get() == invalid_fd), "default constructed resource not invalid");
+	}
+
+	BOOST_TEST(indi_test::empty_deleter_t::call_count == call_count, "deleter called for default constructed resource");
+}
+
+namespace {
+
+// Resource handle with an invalid value, but no default constructor.
+class no_default_handle
+{
+public:
+	constexpr explicit no_default_handle(int value) noexcept : _value{value} {}
+
+	constexpr auto operator==(no_default_handle const&) const noexcept -> bool = default;
+
+private:
+	int _value;
+};
+
+} // anonymous namespace
+
+template <>
+struct indi::resource_traits<no_default_handle>
+{
+	static constexpr auto invalid() noexcept -> no_default_handle { return no_default_handle{-1}; }
+};
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_default_construction_without_default_constructor)
+{
+	using resource_t = indi::unique_resource<no_default_handle, indi_test::empty_deleter_t>;
+
+	BOOST_TEST(not std::is_default_constructible_v<no_default_handle>);
+	BOOST_TEST(std::is_nothrow_default_constructible_v<resource_t>);
+
+	auto const call_count = indi_test::empty_deleter_t::call_count;
+
+	// Artificial scope
+	{
+		auto const r = resource_t{};
+		BOOST_TEST((r.get() == no_default_handle{-1}), "default constructed resource not invalid");
+	}
+
+	BOOST_TEST(indi_test::empty_deleter_t::call_count == call_count, "deleter called for default constructed resource");
+}
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_moving)
+{
+	using resource_t = indi::unique_resource<test_fd, fd_deleter_t>;
+
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	auto p_resource_1 = std::unique_ptr<resource_t>{new resource_t{test_fd{3}, fd_deleter_t{call_count, last_resource}}};
+
+	auto p_resource_2 = std::unique_ptr<resource_t>{new resource_t{std::move(*p_resource_1)}};
+	BOOST_TEST((p_resource_1->get() == invalid_fd), "moved-from resource not invalid");
+	BOOST_TEST((p_resource_2->get() == test_fd{3}));
+
+	p_resource_1.reset();
+	BOOST_TEST(call_count == 0, "deleter called by destroying moved-from resource");
+
+	p_resource_2.reset();
+	BOOST_TEST(call_count == 1);
+	BOOST_TEST(last_resource == 3);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_move_assignment)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto r1 = indi::unique_resource{test_fd{3}, fd_deleter_t{call_count, last_resource}};
+		auto r2 = indi::unique_resource{test_fd{4}, fd_deleter_t{call_count, last_resource}};
+
+		r2 = std::move(r1);
+		BOOST_TEST(call_count == 1, "assigned-to resource not deleted");
+		BOOST_TEST(last_resource == 4);
+		BOOST_TEST((r1.get() == invalid_fd), "moved-from resource not invalid");
+	}
+
+	BOOST_TEST(call_count == 2, "resource deleted twice (or not at all)");
+	BOOST_TEST(last_resource == 3);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_make_unique_resource_checked)
+{
+	auto call_count = 0;
+	auto last_resource = 0;
+
+	// Artificial scope
+	{
+		auto const r1 = indi::make_unique_resource_checked(test_fd{3}, invalid_fd, fd_deleter_t{call_count, last_resource});
+		auto const r2 = indi::make_unique_resource_checked(invalid_fd, invalid_fd, fd_deleter_t{call_count, last_resource});
+	}
+
+	BOOST_TEST(call_count == 1);
+	BOOST_TEST(last_resource == 3);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_resource_CASE_no_flag_stored)
+{
+	constexpr auto lambda = [](test_fd) {};
+
+	BOOST_TEST(sizeof(indi::unique_resource<test_fd, indi_test::empty_deleter_t>) == sizeof(test_fd));
+	BOOST_TEST(sizeof(indi::unique_resource<test_fd, decltype(lambda)>) == sizeof(test_fd));
+	BOOST_TEST(sizeof(indi::unique_resource<test_fd, void(*)(test_fd)>) == sizeof(void(*)(test_fd)) + alignof(void(*)(test_fd)));
+}
+
+/*****************************************************************************
+ * Special operations
+ ****************************************************************************/
+
+BOOST_AUTO_TEST_CASE(not_copyable)
+{
+	using resource_t = indi::unique_resource<int, indi_test::deleter_t<int>>;
+
+	BOOST_TEST(not std::is_copy_constructible_v<resource_t>);
+	BOOST_TEST(not std::is_copy_assignable_v<resource_t>);
+}
+
+BOOST_AUTO_TEST_CASE(nothrow_operations)
+{
+	using resource_t = indi::unique_resource<int, indi_test::deleter_t<int>>;
+
+	BOOST_TEST(std::is_nothrow_move_constructible_v<resource_t>);
+	BOOST_TEST(std::is_nothrow_move_assignable_v<resource_t>);
+	BOOST_TEST(std::is_nothrow_destructible_v<resource_t>);
+	BOOST_TEST((std::is_nothrow_constructible_v<resource_t, int, indi_test::deleter_t<int>>));
+}
+
+BOOST_AUTO_TEST_CASE(default_constructible_only_if_parts_are)
+{
+	BOOST_TEST((std::is_default_constructible_v<indi::unique_resource<int, indi_test::empty_deleter_t>>));
+	BOOST_TEST((not std::is_default_constructible_v<indi::unique_resource<int, indi_test::deleter_t<int>>>));
+	BOOST_TEST((not std::is_default_constructible_v<indi::unique_resource<int&, indi_test::empty_deleter_t>>));
+}
+
+BOOST_AUTO_TEST_CASE(execute_on_reset_constructor_not_public)
+{
+	using resource_t = indi::unique_resource<int, indi_test::deleter_t<int>>;
+
+	BOOST_TEST((not std::is_constructible_v<resource_t, int, indi_test::deleter_t<int>, indi::_detail_X_scope::execute_on_reset_tag>));
+}
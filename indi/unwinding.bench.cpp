@@ -0,0 +1,188 @@
+/*****************************************************************************
+ *
+ * This file is part of libindi-scope.
+ *
+ * libindi-scope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libindi-scope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****************************************************************************/
+
+// Measures how the cost of throwing an exception scales with the number of
+// frames it unwinds through, and the number of scope guards in each frame.
+//
+// For each guard type, an exception is thrown through 1 to 1024 frames,
+// each with 0 to 16 guards. The cost per throw is reported, along with the
+// cost per guard (the extra cost over the same throw through frames with no
+// guards, divided by the total number of guards unwound).
+//
+// The exception is either thrown directly from the innermost frame, or
+// thrown by the constructor of a guard in the innermost frame (when copying
+// its function throws), to measure the function-try-block constructor path.
+// In the latter case, the "0 guards" column is the cost of the failed
+// construction (including its catch and rethrow) alone.
+//
+// Costs are in cycles on x86 (from the time stamp counter), and nanoseconds
+// elsewhere.
+
+#include <array>
+#include <cstdio>
+#include <utility>
+
+#include <indi/scope.hpp>
+
+#include <indi/scope.bench.hpp>
+#include <indi/scope.test.hpp>
+
+namespace {
+
+int counter = 0;
+
+// Always true, but the compiler can't know that (otherwise it would warn
+// that every call to frame() recurses or throws).
+volatile bool should_throw = true;
+
+// Exit function for all guards.
+struct undo_t
+{
+	auto operator()() const noexcept -> void { ++counter; }
+	auto operator()(indi::outcome) const noexcept -> void { ++counter; }
+};
+
+// Exit function that throws when copied (and can't be moved without
+// throwing, so the guard constructor copies it).
+struct throwing_undo_t : undo_t
+{
+	throwing_undo_t() = default;
+	throwing_undo_t(throwing_undo_t const&) { if (should_throw) throw indi_test::exception{}; }
+	throwing_undo_t(throwing_undo_t&&) noexcept(false) {}
+};
+
+[[gnu::noinline]] auto throw_exception() -> void
+{
+	if (should_throw)
+		throw indi_test::exception{};
+}
+
+/*****************************************************************************
+ * Guard types.
+ ****************************************************************************/
+
+template <template <typename> class Guard>
+struct guard_kind
+{
+	static auto make() { return Guard<undo_t>{undo_t{}}; }
+
+	static auto make_throwing() { return Guard<throwing_undo_t>{throwing_undo_t{}}; }
+};
+
+struct exit_kind : guard_kind<indi::scope_exit> { static constexpr auto name = "scope_exit"; };
+struct exit_always_kind : guard_kind<indi::scope_exit_always> { static constexpr auto name = "scope_exit_always"; };
+struct fail_kind : guard_kind<indi::scope_fail> { static constexpr auto name = "scope_fail"; };
+struct success_kind : guard_kind<indi::scope_success> { static constexpr auto name = "scope_success"; };
+struct outcome_kind : guard_kind<indi::scope_outcome> { static constexpr auto name = "scope_outcome"; };
+
+/*****************************************************************************
+ * Frames.
+ ****************************************************************************/
+
+// Creates `Guards` guards, then recurses until `depth` frames deep, where
+// the exception is thrown.
+template <typename Kind, std::size_t Guards, bool ThrowFromConstructor>
+[[gnu::noinline]] auto frame(int depth) -> void
+{
+	auto const guards = []<std::size_t... I>(std::index_sequence<I...>)
+	{
+		return std::array<decltype(Kind::make()), Guards>{((void)I, Kind::make())...};
+	}(std::make_index_sequence<Guards>{});
+
+	if (depth > 1)
+		frame<Kind, Guards, ThrowFromConstructor>(depth - 1);
+	else if constexpr (ThrowFromConstructor)
+		auto const _ = Kind::make_throwing();
+	else
+		throw_exception();
+
+	// Prevents the recursive call from being a tail call.
+	indi_bench::do_not_optimize(guards);
+}
+
+template <typename Kind, std::size_t Guards, bool ThrowFromConstructor>
+auto measure_throw(int depth) -> double
+{
+	return indi_bench::measure_cycles([depth]
+	{
+		try
+		{
+			frame<Kind, Guards, ThrowFromConstructor>(depth);
+		}
+		catch (indi_test::exception const&)
+		{}
+	});
+}
+
+/*****************************************************************************
+ * Running and reporting.
+ ****************************************************************************/
+
+constexpr auto depths = std::array{1, 4, 16, 64, 256, 1024};
+
+template <typename Kind, bool ThrowFromConstructor, std::size_t... Guards>
+auto run(std::index_sequence<Guards...>) -> void
+{
+	std::printf("\n%s, thrown from %s\n", Kind::name, ThrowFromConstructor ? "guard constructor" : "function");
+	std::printf("%6s", "depth");
+	((std::printf("  %10zu guards", Guards)), ...);
+	std::printf("\n");
+
+	for (auto const depth : depths)
+	{
+		auto const costs = std::array{measure_throw<Kind, Guards, ThrowFromConstructor>(depth)...};
+		auto const guard_counts = std::array{Guards...};
+
+		std::printf("%6d", depth);
+		for (auto const cost : costs)
+			std::printf("  %17.0f", cost);
+		std::printf("  %s/throw\n", indi_bench::cycle_unit);
+
+		std::printf("%6s", "");
+		for (auto i = std::size_t{0}; i < costs.size(); ++i)
+		{
+			auto const total_guards = static_cast<double>(depth) * static_cast<double>(guard_counts[i]);
+			std::printf("  %17.1f", total_guards == 0 ? 0.0 : (costs[i] - costs[0]) / total_guards);
+		}
+		std::printf("  %s/guard\n", indi_bench::cycle_unit);
+	}
+}
+
+template <typename Kind, bool ThrowFromConstructor>
+auto run() -> void
+{
+	run<Kind, ThrowFromConstructor>(std::index_sequence<0, 1, 2, 4, 8, 16>{});
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+	run<exit_kind, false>();
+	run<exit_always_kind, false>();
+	run<fail_kind, false>();
+	run<success_kind, false>();
+	run<outcome_kind, false>();
+
+	// The function-try-block constructor path.
+	run<exit_kind, true>();
+	run<fail_kind, true>();
+
+	indi_bench::do_not_optimize(counter);
+}
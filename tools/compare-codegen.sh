@@ -0,0 +1,187 @@
+#!/bin/sh
+##############################################################################
+#
+# This file is part of libindi-scope.
+#
+# libindi-scope is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# libindi-scope is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+#
+##############################################################################
+
+##############################################################################
+#
+# Usage: compare-codegen.sh <assembly file>
+#
+# For every function `<case>__expected` in the assembly file, compares its
+# instructions to those of the function `<case>__actual`. Labels, comments,
+# and assembler directives are ignored.
+#
+# For every function `<case>__no_eh`, checks that neither it, nor any
+# function it (directly or indirectly) calls that is defined in the same
+# assembly file, has exception handling code: a catch handler (which calls
+# `__cxa_begin_catch`), or a cleanup (which ends with `_Unwind_Resume`).
+# Regions that can only terminate, like those of `noexcept` functions, are
+# not counted. (Following the calls means that when the file is compiled
+# without inlining, out-of-line instantiations like constructors are
+# checked too.) For every function `<case>__has_eh`, checks the opposite (to
+# prove that the check can actually detect it).
+#
+# Prints a diff of each mismatching pair. Exits with non-zero status if any
+# pair does not match, if any exception handling check fails, or if there
+# are no cases at all.
+#
+##############################################################################
+
+asm_file="${1:?no assembly file given}"
+
+# Prints the raw assembly of the function named by $1.
+extract_raw()
+{
+	awk -v name="${1}" '
+		$0 == name ":" { found = 1; next }
+		found && /^[[:space:]]*\.cfi_endproc/ { exit }
+		found { print }
+	' "${asm_file}"
+}
+
+# Prints the normalized instructions of the function named by $1.
+extract()
+{
+	extract_raw "${1}" |
+	sed -e 's/[[:space:]]*#.*$//' \
+	    -e '/^[.$A-Za-z0-9_]*:/d' \
+	    -e '/^[[:space:]]*\./d' \
+	    -e '/^[[:space:]]*$/d' \
+	    -e 's/\.L[A-Za-z0-9_$]*/.L/g'
+}
+
+expected_file="$(mktemp)" || exit 1
+actual_file="$(mktemp)" || exit 1
+trap 'rm -f -- "${expected_file}" "${actual_file}"' EXIT
+
+status=0
+count=0
+
+for expected in $(sed -n 's/^\([A-Za-z0-9_]*__expected\):$/\1/p' "${asm_file}")
+do
+	case_name="${expected%__expected}"
+	count=$((count + 1))
+
+	extract "${expected}" >"${expected_file}"
+	extract "${case_name}__actual" >"${actual_file}"
+
+	if [ ! -s "${actual_file}" ]
+	then
+		printf '%s\n' "${asm_file}: ${case_name}: no instructions found for ${case_name}__actual" >&2
+		status=1
+	elif ! diff -u --label "${case_name}__expected" --label "${case_name}__actual" "${expected_file}" "${actual_file}"
+	then
+		printf '%s\n' "${asm_file}: ${case_name}: generated code differs" >&2
+		status=1
+	else
+		printf '%s\n' "${asm_file}: ${case_name}: OK"
+	fi
+done
+
+# Succeeds if the function named by $1, or any function it calls that is
+# defined in the assembly file, has exception handling code. The cold parts
+# of functions (`<function>.cold`), where GCC puts landing pads, are
+# included.
+has_eh()
+{
+	awk -v name="${1}" '
+		# Function bodies, and aliases (like complete object constructors,
+		# which GCC emits as aliases of base object constructors).
+		/^[$A-Za-z0-9_][.$A-Za-z0-9_]*:$/ { current = substr($0, 1, length($0) - 1); next }
+		/^[[:space:]]*\.cfi_endproc/ { current = ""; next }
+		/^[[:space:]]*\.set[[:space:]]/ {
+			line = $0
+			sub(/^[[:space:]]*\.set[[:space:]]+/, "", line)
+			gsub(/[[:space:]]/, "", line)
+			split(line, parts, ",")
+			alias[parts[1]] = parts[2]
+			next
+		}
+		current != "" { body[current] = body[current] $0 "\n" }
+
+		END {
+			queue[1] = name
+			seen[name] = 1
+			n = 1
+			for (i = 1; i <= n; i++)
+			{
+				f = queue[i]
+				if (f in alias)
+					f = alias[f]
+				if (f !~ /\.cold$/ && !((f ".cold") in seen))
+				{
+					seen[f ".cold"] = 1
+					queue[++n] = f ".cold"
+				}
+
+				if (body[f] ~ /__cxa_(begin_catch|end_catch|rethrow)|_Unwind_Resume/)
+					exit 0
+
+				lines = split(body[f], insns, "\n")
+				for (j = 1; j <= lines; j++)
+				{
+					if (insns[j] !~ /^[[:space:]]*(call|jmp)[a-z]*[[:space:]]/)
+						continue
+					target = insns[j]
+					sub(/^[[:space:]]*[a-z]+[[:space:]]+/, "", target)
+					sub(/@PLT.*$/, "", target)
+					sub(/[[:space:]].*$/, "", target)
+					if (!(target in seen))
+					{
+						seen[target] = 1
+						queue[++n] = target
+					}
+				}
+			}
+			exit 1
+		}
+	' "${asm_file}"
+}
+
+for function_name in $(sed -E -n 's/^([A-Za-z0-9_]*__(no|has)_eh):$/\1/p' "${asm_file}")
+do
+	count=$((count + 1))
+
+	case "${function_name}" in
+		*__no_eh) expect_eh=false ;;
+		*)        expect_eh=true ;;
+	esac
+
+	if has_eh "${function_name}"
+	then
+		found_eh=true
+	else
+		found_eh=false
+	fi
+
+	if [ "${found_eh}" != "${expect_eh}" ]
+	then
+		printf '%s\n' "${asm_file}: ${function_name}: exception handling code $( "${expect_eh}" && printf 'expected, but not found' || printf 'found, but not expected' )" >&2
+		status=1
+	else
+		printf '%s\n' "${asm_file}: ${function_name}: OK"
+	fi
+done
+
+if [ "${count}" -eq 0 ]
+then
+	printf '%s\n' "${asm_file}: no codegen test cases found" >&2
+	status=1
+fi
+
+exit "${status}"
@@ -0,0 +1,244 @@
+#!/bin/sh
+##############################################################################
+#
+# This file is part of libindi-scope.
+#
+# libindi-scope is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# libindi-scope is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with libindi-scope.  If not, see <https://www.gnu.org/licenses/>.
+#
+##############################################################################
+
+##############################################################################
+#
+# Usage: footprint.sh [--update] <source file> <baseline file>
+#
+# Compiles the source file (at -O2) once without a scope guard, and once for
+# every scope guard and test functor combination, and prints how much each
+# combination grows the `.text`, `.eh_frame`, and `.gcc_except_table`
+# sections (in bytes) over the version without a scope guard.
+#
+# Every combination is compiled in two modes: "inline" (the guard's member
+# functions are inlined, as usual at -O2), and "outline" (with
+# `-fno-inline`, so the guard's constructor, destructor, and their landing
+# pads are emitted as separate functions, as happens when the compiler
+# decides not to inline them).
+#
+# The compiler and flags are taken from the CXX, CXXFLAGS, and CPPFLAGS
+# environment variables.
+#
+# Each combination is then checked against the baseline file. Exits with
+# non-zero status if any section grew beyond its baseline, or if any
+# combination is missing from the baseline.
+#
+# The numbers depend on the compiler and flags, so the baseline file has one
+# section of numbers per configuration, each headed by a line like:
+#       # gcc 12 -std=c++20 -O2
+# The configuration is the compiler and its major version, followed by only
+# the flags that change the generated code: the last `-std` and `-O` flags,
+# and every `-f`, `-m`, `-stdlib`, and `-DINDI_` flag, in order. (So, for
+# example, include paths and warning flags don't matter.)
+#
+# If the baseline file has no section for the current configuration, that
+# is an error, unless the FOOTPRINT_ALLOW_MISMATCH environment variable is
+# set to 1, in which case the numbers are printed but not checked.
+#
+# With `--update`, the section for the current configuration is rewritten
+# with the current numbers (or added) instead of being checked.
+#
+##############################################################################
+
+update=false
+if [ "${1}" = '--update' ]
+then
+	update=true
+	shift
+fi
+
+source_file="${1:?no source file given}"
+baseline_file="${2:?no baseline file given}"
+
+guards='scope_exit scope_exit_always scope_fail scope_success scope_outcome
+        scope_fail_if scope_success_if
+        scope_exit_fn scope_fail_fn scope_success_fn
+        scope_exit_assignable scope_fail_assignable scope_success_assignable
+        scope_exit_all scope_fail_all scope_success_all guard_set
+        scope_exit_ref scope_fail_ref scope_success_ref
+        any_scope_exit unique_resource
+        scope_stack_on_exit scope_stack_on_fail scope_stack_on_success
+        transaction_on_rollback'
+nothrow_functors='functor_t const_functor_t noexcept_functor_t const_noexcept_functor_t move_only_functor_t copy_only_functor_t move_throws_functor_t'
+functors="${nothrow_functors} throwing_copy_functor_t"
+
+# Prints the functors to use with the given guard: none for the guards with
+# the function as a template argument, and only the ones that can be moved
+# or copied without throwing for the guards that require that.
+guard_functors()
+{
+	case "${1}" in
+		*_fn)                        printf '%s\n' 'none' ;;
+		*_assignable|any_scope_exit) printf '%s\n' "${nothrow_functors}" ;;
+		*)                           printf '%s\n' "${functors}" ;;
+	esac
+}
+
+cxx="${CXX:-c++}"
+flags="${CXXFLAGS} ${CPPFLAGS} -O2 -g0"
+
+# The compiler and its major version (like `gcc 12` or `clang 11`).
+compiler="$(
+	printf '%s\n' '#if defined(__clang__)' 'clang __clang_major__' \
+	               '#elif defined(__GNUC__)' 'gcc __GNUC__' \
+	               '#else' 'unknown' '#endif' |
+	# shellcheck disable=SC2086
+	"${cxx}" ${flags} -E -P -x c++ - | sed '/^ *$/d'
+)" || exit 1
+
+# The flags that change the generated code.
+code_flags="$(
+	# shellcheck disable=SC2086
+	printf '%s\n' ${flags} | awk '
+		/^-std=/                        { std = " " $0; next }
+		/^-O/                           { optimization = " " $0; next }
+		/^-(f|m|stdlib=|DINDI_)/        { other = other " " $0 }
+		END { print std optimization other }
+	'
+)"
+
+configuration="# ${compiler}${code_flags}"
+
+work_dir="$(mktemp -d)" || exit 1
+trap 'rm -rf -- "${work_dir}"' EXIT
+
+# Compiles the source file with the given extra flags into an object file
+# with the given name, and prints the total sizes of the text, eh_frame, and
+# gcc_except_table sections.
+#
+# Template instantiations go in their own (COMDAT) sections, like
+# `.text._ZN...`, so those are included in the totals.
+sizes()
+{
+	object_file="${work_dir}/${1}.o"
+	shift
+
+	# shellcheck disable=SC2086
+	"${cxx}" ${flags} -I. "${@}" -c -o "${object_file}" "${source_file}" || return 1
+
+	size -A "${object_file}" | awk '
+		$1 ~ /^\.text/              { text += $2 }
+		$1 == ".eh_frame"           { eh_frame += $2 }
+		$1 ~ /^\.gcc_except_table/  { except_table += $2 }
+		END { print text + 0, eh_frame + 0, except_table + 0 }
+	'
+}
+
+results="${work_dir}/results"
+
+for mode in inline outline
+do
+	if [ "${mode}" = 'outline' ]
+	then
+		mode_flag='-fno-inline'
+	else
+		mode_flag='-finline'
+	fi
+
+	base_sizes="$(sizes base "${mode_flag}")" || exit 1
+
+	for guard in ${guards}
+	do
+		# The functors of a guard are compiled in parallel.
+		pids=''
+		for functor in $(guard_functors "${guard}")
+		do
+			sizes "${functor}" "${mode_flag}" "-DINDI_FOOTPRINT_GUARD=${guard}" "-DINDI_FOOTPRINT_FUNCTOR=${functor}" \
+				>"${work_dir}/${functor}.sizes" &
+			pids="${pids} ${!}"
+		done
+
+		for pid in ${pids}
+		do
+			wait "${pid}" || exit 1
+		done
+
+		for functor in $(guard_functors "${guard}")
+		do
+			printf '%s %s %s %s %s\n' "${mode}" "${guard}" "${functor}" "$(cat "${work_dir}/${functor}.sizes")" "${base_sizes}" |
+			awk '{ print $1, $2, $3, $4 - $7, $5 - $8, $6 - $9 }'
+		done
+	done
+done >"${results}"
+
+printf '%-8s %-24s %-28s %8s %10s %18s\n' 'mode' 'guard' 'functor' '.text' '.eh_frame' '.gcc_except_table'
+awk '{ printf "%-8s %-24s %-28s %8d %10d %18d\n", $1, $2, $3, $4, $5, $6 }' "${results}"
+
+# Prints the baseline file without the section for the current
+# configuration (if it has one), or with only that section (without its
+# heading) if the argument is `only`.
+baseline_section()
+{
+	[ -f "${baseline_file}" ] || return 0
+
+	awk -v configuration="${configuration}" -v only="${1}" '
+		/^#/ { in_section = ($0 == configuration); if (only != "only" && !in_section) print; next }
+		(only == "only") == in_section { print }
+	' "${baseline_file}"
+}
+
+if "${update}"
+then
+	baseline_section >"${work_dir}/baseline" || exit 1
+	{ cat "${work_dir}/baseline" && printf '%s\n' "${configuration}" && cat "${results}" ; } >"${baseline_file}"
+	printf '%s\n' "Baseline for '${configuration#\# }' written to ${baseline_file}."
+	exit 0
+fi
+
+baseline_section only >"${work_dir}/baseline" || exit 1
+
+if [ ! -s "${work_dir}/baseline" ]
+then
+	printf '%s\n' "${baseline_file}: no baseline for '${configuration#\# }'" \
+	               "    (run with --update to record one)" >&2
+	if [ "${FOOTPRINT_ALLOW_MISMATCH}" = '1' ]
+	then
+		printf '%s\n' 'footprint: not checked (FOOTPRINT_ALLOW_MISMATCH=1)'
+		exit 0
+	fi
+	exit 1
+fi
+
+awk '
+	NR == FNR { baseline[$1 " " $2 " " $3] = $4 " " $5 " " $6; next }
+	{
+		key = $1 " " $2 " " $3
+		if (!(key in baseline))
+		{
+			print "footprint: " key ": no baseline" > "/dev/stderr"
+			status = 1
+			next
+		}
+
+		split(baseline[key], b, " ")
+		split(".text .eh_frame .gcc_except_table", names, " ")
+		for (i = 1; i <= 3; ++i)
+		{
+			if ($(i + 3) > b[i])
+			{
+				print "footprint: " key ": " names[i] " grew from " b[i] " to " $(i + 3) " bytes" > "/dev/stderr"
+				status = 1
+			}
+		}
+	}
+	END { exit status }
+' "${work_dir}/baseline" "${results}" || exit 1
+
+printf '%s\n' 'footprint: OK'